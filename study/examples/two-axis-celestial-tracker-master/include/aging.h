@@ -0,0 +1,69 @@
+#ifndef AGING_H
+#define AGING_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+#include "debug.h"
+#include "Time.h"
+#else
+#include <stdint.h>
+#include <time.h>
+#endif
+
+// aging calibration **********************************************************
+// The drift of the RTC is measured against a reference, see aging.cpp, and
+// the aging register is set to cancel it at the temperature of the last days.
+// AGING_PULSE measures the RTC against a pulse at the start of every second,
+// e.g. the PPS output of a GPS receiver, on aging_pulse_pin. Without it the
+// reference is only the time sent over Serial at start up.
+// #define AGING_PULSE
+
+#define aging_pulse_pin A1              // rising edge at the start of a second
+#define aging_pulse_interval 21600L     // seconds between pulse measurements
+#define aging_min_interval 43200L       // seconds between corrections of a sample
+#define aging_save_interval 21600L      // seconds between saves of the sums
+#define aging_temperature_interval 600L // seconds between temperature reads
+#define aging_samples 8                 // drift samples kept for the fit
+#define aging_lsb 10                    // 0.01 ppm per aging register step
+#define aging_eeprom 896                // EEPROM address of aging_state
+
+/**
+ * Drift of the RTC over the interval between two corrections
+ */
+struct aging_sample
+{
+  int16_t rate;        // 0.01 ppm at aging 0, positive runs fast
+  int16_t temperature; // mean over the interval, 0.25 C
+  uint16_t hours;      // length of the interval, the weight in the fit
+};
+
+/**
+ * Everything kept in EEPROM, the sums run since the last correction
+ */
+struct aging_state
+{
+  time_t since;          // time of the last correction, 0 if none
+  long error_ms;         // error of the RTC just after that correction
+  float seconds;         // time summed
+  float temperature_sum; // temperature * seconds, 0.25 C
+  float aging_sum;       // aging register * seconds
+  uint8_t count;         // samples in use
+  uint8_t next;          // sample that is replaced next
+  aging_sample samples[aging_samples];
+};
+
+void aging_sum(aging_state *st, float seconds, int temperature, int aging);
+void aging_sample_add(aging_state *st, time_t t, long error_ms);
+float aging_fit(const aging_state *st, float temperature);
+int aging_target(const aging_state *st, float temperature, int aging);
+
+#ifdef ARDUINO
+void aging_update(time_t t);
+void aging_correct(time_t t, long error_ms, long step_ms);
+#ifdef SERIAL_BPS
+void agingSerial();
+#endif
+#endif
+
+#endif
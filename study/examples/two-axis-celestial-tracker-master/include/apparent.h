@@ -0,0 +1,38 @@
+#include <Arduino.h>
+
+#include "debug.h"
+#include "Time.h"
+
+// apparent place *************************************************************
+// Each correction stage is only compiled when switched on here. A stage that
+// is switched off costs no flash and no cycles.
+
+// APPARENT_PRECESSION precesses the J2000 catalog stars to the equinox of
+// date, about 50" per year. The planets are already computed of date
+// #define APPARENT_PRECESSION
+
+// APPARENT_NUTATION adds nutation in longitude and obliquity, up to 17"
+// #define APPARENT_NUTATION
+
+// APPARENT_ABERRATION adds the annual aberration, up to 20"
+// #define APPARENT_ABERRATION
+
+// APPARENT_REFRACTION lifts the altitude for atmospheric refraction, 29'
+// at the horizon and zero at the zenith
+// #define APPARENT_REFRACTION
+
+// seconds in a julian century and the J2000.0 epoch in unix time
+#define secs_per_century 3155760000.0
+#define secs_j2000 946728000.0
+
+#if defined(APPARENT_PRECESSION) || defined(APPARENT_NUTATION) || defined(APPARENT_ABERRATION)
+void apparentPlace(int index, time_t now, double *object_ra, double *object_dc);
+#else
+inline void apparentPlace(int index, time_t now, double *object_ra, double *object_dc) {}
+#endif
+
+#ifdef APPARENT_REFRACTION
+double apparentAltitude(double object_al_d);
+#else
+inline double apparentAltitude(double object_al_d) { return object_al_d; }
+#endif
@@ -1,9 +1,11 @@
+#ifndef ASTRONOMY_H
+#define ASTRONOMY_H
+
 #include <Arduino.h>
 
 #include "debug.h"
 #include "Time.h"
-
-#define pi 3.141592653589793
+#include "orbit.h"
 
 // https://en.wikipedia.org/wiki/Sidereal_time
 #define solar_ms_seconds_per_sidereal_day 86164091ull
@@ -15,10 +17,51 @@
 // now subtract the ms between 2019-01-01 and 1970-01-01: 1546300800000
 #define siderial_ms_offset 1546276779239ull
 
-#define max_object 14
+// seconds the sidereal clock may advance before it is seeded again. Must be
+// less than one sidereal day
+#define sidereal_max_advance 86164ul
+
+// getHorizontal() uses a position again while the object moved less than
+// cache_error arc seconds, about a quarter of a motor step. cache_window
+// converts a rate in degrees per day to the seconds that takes
+#define cache_error 150.0
+#define cache_window(rate) ((uint32_t)(cache_error * 24.0 / (rate)))
+#define cache_window_stars 86400ul // precession and aberration are slow
+
+// SATELLITE adds a satellite, tracked with SGP4 from the elements in EEPROM,
+// as the object after the stars
+// #define SATELLITE
+
+// MINOR_BODIES adds that many comets or asteroids, from the elements in
+// EEPROM, as the objects after the stars and the satellite
+// #define MINOR_BODIES 4
 
-void getObject(int index, time_t now, double *object_ra, double *object_dc);
+#define last_star 14
+
+#ifdef SATELLITE
+#define object_satellite (last_star + 1)
+#define first_minor (object_satellite + 1)
+#else
+#define first_minor (last_star + 1)
+#endif
+
+#ifdef MINOR_BODIES
+#define max_object (first_minor + MINOR_BODIES - 1)
+#else
+#define max_object (first_minor - 1)
+#endif
+
+void getObject(int index, time_t now, double *object_ra, double *object_dc, double *object_ro);
+void topocentric(int index, double object_ro, double loc_lat_d, double sidereal_r,
+                 double *object_ra, double *object_dc);
 void transform(double object_ra_h, double object_dc_d,
                double loc_lat_d, double sidereal_r,
                double *object_az_d, double *object_al_d);
+void getHorizontal(int index, time_t now, double loc_lat_d, double sidereal_r,
+                   double *object_az_d, double *object_al_d, bool cached = true);
+void clearHorizontalCache();
 double getSiderealAngle(time_t t, double loc_lng_d);
+void syncSiderealClock(time_t t, double loc_lng_d);
+double getSiderealClock(time_t t, double loc_lng_d);
+
+#endif
@@ -8,8 +8,9 @@
 #include "astronomy.h"
 #include "location.h"
 
-#define calibrate_pin 10 // pushbutton to ground
-#define beep_pin 12      // Piezo beeper
+#define calibrate_pin 10      // pushbutton to ground
+#define beep_pin 12           // Piezo beeper
+#define backlash_delay_ms 250 // per step while measuring backlash
 
 void calibration_mode();
 void beep_calibrate(int header, int beeps);
@@ -6,6 +6,11 @@
 // debugging the math
 // #define SERIAL_DEBUG
 
-#if defined(SERIAL_DEBUG) || defined(SERIAL_POS)
+// MOTOR_BENCH prints the cycles per step of every motor driver at start up,
+// measured on pins A0-A3, which drives them and so they must be unconnected.
+// RTC_ALARM and AGING_PULSE use A3 and A1 as inputs, see main.h
+// #define MOTOR_BENCH
+
+#if defined(SERIAL_DEBUG) || defined(SERIAL_POS) || defined(MOTOR_BENCH)
 #define SERIAL_BPS 9600
 #endif
@@ -5,5 +5,14 @@
 #include <Time.h>
 #include "DS3232RTC.h"
 
-int rtcRead(int adr);
-void rtcWrite(int adr, int value);
+// steps a position in RAM may run ahead of the NVRAM during a move
+#define journal_steps 8
+
+// backlash is kept in a byte per axis, in steps
+#define backlash_max 255
+
+int journal_read(int adr);
+void journal_write(int adr, int value);
+void journal_flush();
+int backlash_read(int adr);
+void backlash_write(int adr, int value);
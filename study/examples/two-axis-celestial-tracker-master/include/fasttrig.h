@@ -0,0 +1,35 @@
+#ifndef FASTTRIG_H
+#define FASTTRIG_H
+
+#include <math.h>
+#include <stdint.h>
+
+// fast trigonometry **********************************************************
+// FAST_TRIG replaces sin, cos, atan and atan2 in the astronomy code by fixed
+// point polynomials, which take a fraction of the cycles of the float library.
+// The error is below 9.1" for sin and cos and below 13" for atan and atan2,
+// far less than a motor step (633"). Without FAST_TRIG the float library is
+// used. tools/trigcheck.cpp measures the errors.
+// #define FAST_TRIG
+
+#define trig_units 16777216.0 // binary angle units per turn, 24 bits
+#define trig_reduce 512.0     // rads above which the angle is reduced first
+
+double fastSin(double x);
+double fastCos(double x);
+double fastAtan2(double y, double x);
+double fastAtan(double z);
+
+#ifdef FAST_TRIG
+#define trig_sin(x) fastSin(x)
+#define trig_cos(x) fastCos(x)
+#define trig_atan2(y, x) fastAtan2(y, x)
+#define trig_atan(z) fastAtan(z)
+#else
+#define trig_sin(x) sin(x)
+#define trig_cos(x) cos(x)
+#define trig_atan2(y, x) atan2(y, x)
+#define trig_atan(z) atan(z)
+#endif
+
+#endif
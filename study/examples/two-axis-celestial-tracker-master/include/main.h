@@ -4,10 +4,25 @@
 
 #include "stepper.h"
 #include "ds3231.h"
+#include "store.h"
 #include "location.h"
 #include "astronomy.h"
+#include "skygrid.h"
+#include "riseset.h"
+#include "trajectory.h"
+#include "satellite.h"
 #include "calibrate.h"
 #include "power.h"
+#include "aging.h"
 
-void set_pointer(double sidereal_r);
+#if defined(MOTOR_BENCH) && (defined(RTC_ALARM) || defined(AGING_PULSE))
+#error "MOTOR_BENCH drives A0-A3, RTC_ALARM and AGING_PULSE connect outputs to them"
+#endif
+
+double get_ticks(time_t t, double sidereal_r, int az_from, int *az_ticks, int *al_ticks,
+                 double *az_steps = NULL, double *al_steps = NULL, bool cached = true);
+double set_pointer(double sidereal_r, int az_from);
+unsigned long update_pointer();
+unsigned long satellite_pass();
+unsigned long sleep_to_rise();
 void set_lang_long(double lat, double lng);
@@ -0,0 +1,301 @@
+#ifndef MOTOR_H
+#define MOTOR_H
+
+#include <Arduino.h>
+
+// motor drivers **************************************************************
+// Every driver is a class template with its pins, and for the ULN2003 its
+// coil sequence, as template parameters. The coil pattern for every port is
+// computed by the compiler into a table in flash, so a step is one table
+// read and one write per port instead of four digitalWrite() calls. The
+// port registers are those of the ATmega328 (and 168, 88), on other boards
+// the drivers fall back to digitalWrite() with the same functions. They
+// only need Arduino.h, so other sketches can include this file as well.
+//
+// All drivers have the same static functions
+// - begin() sets the pins to output
+// - hold(position) energizes the motor at position, without a step
+// - step(position) steps to position, which is next to the last one
+// - idle() in between the steps of a line: a ULN2003 is released, a step/dir
+//   driver keeps its holding current, set on the driver itself
+// - release() removes power, the gears hold the motor in place
+
+// ULN2003 coil sequences, one nibble per phase starting at the lowest, bit n
+// is motor pin first + n. Both have eight phases, the full step sequence
+// repeats its four, so the phase is always position & 7
+#define uln2003_full_step 0x6c936c93ul // 0011 1001 1100 0110 pairs of coils
+#define uln2003_half_step 0x264c8913ul // with a single coil in between
+
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega168P__) || defined(__AVR_ATmega88__)
+
+/**
+ * Arduino pin to port of the ATmega328: 0-7 PORTD, 8-13 PORTB, A0-A5 PORTC
+ */
+constexpr uint8_t motor_port(uint8_t pin)
+{
+  return pin < 8 ? 0 : pin < 14 ? 1 : 2;
+}
+
+constexpr uint8_t motor_bit(uint8_t pin)
+{
+  return pin < 8 ? pin : pin < 14 ? pin - 8 : pin - 14;
+}
+
+constexpr uint8_t motor_mask(uint8_t pin)
+{
+  return 1 << motor_bit(pin);
+}
+
+/**
+ * Port bits of the four pins from first_pin on a port
+ */
+constexpr uint8_t motor_pins(uint8_t first_pin, uint8_t port, uint8_t n = 0)
+{
+  return n == 4 ? 0
+                : (motor_port(first_pin + n) == port ? motor_mask(first_pin + n) : 0) |
+                      motor_pins(first_pin, port, n + 1);
+}
+
+/**
+ * Port bits of the coils that are on in a phase of a ULN2003 sequence
+ */
+constexpr uint8_t motor_coils(uint8_t first_pin, uint8_t port, uint32_t sequence, uint8_t phase, uint8_t n = 0)
+{
+  return n == 4 ? 0
+                : (motor_port(first_pin + n) == port && (sequence >> (4 * phase + n) & 1) ? motor_mask(first_pin + n) : 0) |
+                      motor_coils(first_pin, port, sequence, phase, n + 1);
+}
+
+/**
+ * Port registers by motor_port()
+ */
+template <uint8_t port>
+struct motor_registers;
+
+template <>
+struct motor_registers<0>
+{
+  static volatile uint8_t &out() { return PORTD; }
+  static volatile uint8_t &ddr() { return DDRD; }
+};
+
+template <>
+struct motor_registers<1>
+{
+  static volatile uint8_t &out() { return PORTB; }
+  static volatile uint8_t &ddr() { return DDRB; }
+};
+
+template <>
+struct motor_registers<2>
+{
+  static volatile uint8_t &out() { return PORTC; }
+  static volatile uint8_t &ddr() { return DDRC; }
+};
+
+/**
+ * ULN2003 board on four consecutive pins. The pins may be split over two
+ * ports (e.g. 6-9 is PD6, PD7, PB0, PB1), which then costs a second write.
+ */
+template <uint8_t first_pin, uint32_t sequence>
+class motor_uln2003
+{
+  static const uint8_t port_first = motor_port(first_pin);
+  static const uint8_t port_last = motor_port(first_pin + 3);
+  typedef motor_registers<port_first> first;
+  typedef motor_registers<port_last> last;
+
+  static const uint8_t pattern_first[8];
+  static const uint8_t pattern_last[8];
+
+public:
+  static const uint8_t mask_first = motor_pins(first_pin, port_first);
+  static const uint8_t mask_last = motor_pins(first_pin, port_last);
+
+  static void begin()
+  {
+    first::ddr() |= mask_first;
+    if (port_last != port_first)
+      last::ddr() |= mask_last;
+  }
+
+  static void hold(int position)
+  {
+    uint8_t phase = position & 7;
+    first::out() = (first::out() & ~mask_first) | pgm_read_byte(&pattern_first[phase]);
+    if (port_last != port_first)
+      last::out() = (last::out() & ~mask_last) | pgm_read_byte(&pattern_last[phase]);
+  }
+
+  static void step(int position)
+  {
+    hold(position);
+  }
+
+  static void idle()
+  {
+    release();
+  }
+
+  static void release()
+  {
+    first::out() &= ~mask_first;
+    if (port_last != port_first)
+      last::out() &= ~mask_last;
+  }
+};
+
+template <uint8_t first_pin, uint32_t sequence>
+const uint8_t motor_uln2003<first_pin, sequence>::pattern_first[8] PROGMEM = {
+    motor_coils(first_pin, port_first, sequence, 0), motor_coils(first_pin, port_first, sequence, 1),
+    motor_coils(first_pin, port_first, sequence, 2), motor_coils(first_pin, port_first, sequence, 3),
+    motor_coils(first_pin, port_first, sequence, 4), motor_coils(first_pin, port_first, sequence, 5),
+    motor_coils(first_pin, port_first, sequence, 6), motor_coils(first_pin, port_first, sequence, 7)};
+
+template <uint8_t first_pin, uint32_t sequence>
+const uint8_t motor_uln2003<first_pin, sequence>::pattern_last[8] PROGMEM = {
+    motor_coils(first_pin, port_last, sequence, 0), motor_coils(first_pin, port_last, sequence, 1),
+    motor_coils(first_pin, port_last, sequence, 2), motor_coils(first_pin, port_last, sequence, 3),
+    motor_coils(first_pin, port_last, sequence, 4), motor_coils(first_pin, port_last, sequence, 5),
+    motor_coils(first_pin, port_last, sequence, 6), motor_coils(first_pin, port_last, sequence, 7)};
+
+/**
+ * Step/dir driver (A4988, DRV8825, TMC2208) with an active low enable. The
+ * pulse and the direction setup are stretched to 1 us, the minimum of the
+ * A4988.
+ */
+template <uint8_t step_pin, uint8_t dir_pin, uint8_t enable_pin>
+class motor_step_dir
+{
+  typedef motor_registers<motor_port(step_pin)> step_port;
+  typedef motor_registers<motor_port(dir_pin)> dir_port;
+  typedef motor_registers<motor_port(enable_pin)> enable_port;
+
+  static int last;
+
+public:
+  static void begin()
+  {
+    step_port::ddr() |= motor_mask(step_pin);
+    dir_port::ddr() |= motor_mask(dir_pin);
+    enable_port::out() |= motor_mask(enable_pin); // disabled
+    enable_port::ddr() |= motor_mask(enable_pin);
+  }
+
+  static void hold(int position)
+  {
+    enable_port::out() &= ~motor_mask(enable_pin);
+    last = position;
+  }
+
+  static void step(int position)
+  {
+    enable_port::out() &= ~motor_mask(enable_pin);
+    if (position > last)
+      dir_port::out() |= motor_mask(dir_pin);
+    else
+      dir_port::out() &= ~motor_mask(dir_pin);
+    delayMicroseconds(1);
+    step_port::out() |= motor_mask(step_pin);
+    delayMicroseconds(1);
+    step_port::out() &= ~motor_mask(step_pin);
+    last = position;
+  }
+
+  static void idle()
+  {
+  }
+
+  static void release()
+  {
+    enable_port::out() |= motor_mask(enable_pin);
+  }
+};
+
+#else
+/**
+ * ULN2003 board on four consecutive pins, by digitalWrite()
+ */
+template <uint8_t first_pin, uint32_t sequence>
+class motor_uln2003
+{
+public:
+  static void begin()
+  {
+    for (uint8_t n = 0; n < 4; n++)
+      pinMode(first_pin + n, OUTPUT);
+  }
+
+  static void hold(int position)
+  {
+    uint8_t phase = position & 7;
+    for (uint8_t n = 0; n < 4; n++)
+      digitalWrite(first_pin + n, sequence >> (4 * phase + n) & 1 ? HIGH : LOW);
+  }
+
+  static void step(int position)
+  {
+    hold(position);
+  }
+
+  static void idle()
+  {
+    release();
+  }
+
+  static void release()
+  {
+    for (uint8_t n = 0; n < 4; n++)
+      digitalWrite(first_pin + n, LOW);
+  }
+};
+
+/**
+ * Step/dir driver with an active low enable, by digitalWrite()
+ */
+template <uint8_t step_pin, uint8_t dir_pin, uint8_t enable_pin>
+class motor_step_dir
+{
+  static int last;
+
+public:
+  static void begin()
+  {
+    pinMode(step_pin, OUTPUT);
+    pinMode(dir_pin, OUTPUT);
+    digitalWrite(enable_pin, HIGH); // disabled
+    pinMode(enable_pin, OUTPUT);
+  }
+
+  static void hold(int position)
+  {
+    digitalWrite(enable_pin, LOW);
+    last = position;
+  }
+
+  static void step(int position)
+  {
+    digitalWrite(enable_pin, LOW);
+    digitalWrite(dir_pin, position > last ? HIGH : LOW);
+    delayMicroseconds(1);
+    digitalWrite(step_pin, HIGH);
+    delayMicroseconds(1);
+    digitalWrite(step_pin, LOW);
+    last = position;
+  }
+
+  static void idle()
+  {
+  }
+
+  static void release()
+  {
+    digitalWrite(enable_pin, HIGH);
+  }
+};
+#endif
+
+template <uint8_t step_pin, uint8_t dir_pin, uint8_t enable_pin>
+int motor_step_dir<step_pin, dir_pin, enable_pin>::last = 0;
+
+#endif
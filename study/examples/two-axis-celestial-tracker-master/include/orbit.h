@@ -0,0 +1,53 @@
+#ifndef ORBIT_H
+#define ORBIT_H
+
+#include <math.h>
+
+#define pi 3.141592653589793
+
+#define gaussian_k 0.01720209895      // Gaussian gravitational constant, rads per day
+#define precession_per_day 6.67403e-7 // J2000 to equinox of date, rads per day
+#define near_parabolic 0.005          // |e - 1| below which an orbit is near parabolic
+
+// EEPROM address of the minor body elements, MINOR_BODIES records
+#define minor_eeprom 64
+
+/**
+ * Heliocentric elements of a comet or asteroid, referred to the J2000
+ * ecliptic and equinox as published by the MPC. The perihelion time and
+ * distance describe elliptic, parabolic and hyperbolic orbits alike.
+ */
+struct orbit_elements
+{
+  float tp;   // time of perihelion in days, same scale as d in getPlanet()
+  float q;    // perihelion distance in AU
+  float e;    // eccentricity
+  float i;    // inclination in rads
+  float node; // longitude of the ascending node in rads
+  float peri; // argument of perihelion in rads
+};
+
+/**
+ * Geocentric position as computed by orbitBatch()
+ */
+struct orbit_position
+{
+  double ra;    // Right Ascention in hours
+  double dc;    // Declination in degrees
+  double r;     // distance to the sun in AU
+  double delta; // distance to the earth in AU
+};
+
+void orbitSun(double d, double *Ms, double *ws, double *lonsun, double *rs);
+void orbitHeliocentric(const orbit_elements *el, double d,
+                       double *xh, double *yh, double *zh);
+void orbitEquatorial(double d, double xg, double yg, double zg,
+                     double *object_ra, double *object_dc);
+void orbitBatch(const orbit_elements *el, int count, double d, orbit_position *pos);
+
+#ifdef ARDUINO
+void minorElements(int slot, orbit_elements *el);
+void minorSerial();
+#endif
+
+#endif
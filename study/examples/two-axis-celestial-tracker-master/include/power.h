@@ -8,7 +8,33 @@
 #define rtc_power_pin 11 // powers the RTC chip
 #define ADMUX_VCCWRT1V1 (_BV(REFS0) | _BV(MUX3) | _BV(MUX2) | _BV(MUX1))
 
-void sleep();
+#define sleep_default 40    // seconds between pointer updates
+#define sleep_granularity 4 // seconds per power down
+
+// RTC_ALARM wakes the processor by an alarm of the RTC, instead of every
+// sleep_granularity seconds by the watchdog. The INT/SQW output of the RTC
+// must be wired to rtc_alarm_pin. A DS3232 wakes it by alarm 1 at the exact
+// second of the next update. On a DS3231 alarm 1 holds the store, so alarm 2
+// wakes it at the whole minute before the update and the watchdog sleeps
+// the seconds after that.
+// #define RTC_ALARM
+
+#define rtc_alarm_pin A3    // INT/SQW of the RTC, open drain
+#define alarm_window 86340L // longest sleep, alarm 2 repeats daily
+#define alarm_margin 8      // the clock may be seconds off the RTC and a missed
+                            // alarm sleeps a day, shorter sleeps use the watchdog
+
+// Timer0 stops in power down, so sleep() adds the time asleep to the software
+// clock: the alarm time, or the watchdog slices at their measured length.
+// time_sync() reads the time from the RTC only every time_sync_interval
+// seconds and after a wake up by the button.
+#define time_sync_interval 1800 // seconds between reads of the RTC time
+#define time_measure 600        // seconds of slices that measure a slice
+#define slice_min_ms 3000       // limits of a measured slice, the watchdog
+#define slice_max_ms 5000       // oscillator is only within 10 %
+
+void sleep(unsigned long seconds);
+void time_sync();
 void power_on();
 void power_off();
 boolean battery_check();
@@ -0,0 +1,34 @@
+#ifndef RISESET_H
+#define RISESET_H
+
+#include <Arduino.h>
+
+#include "debug.h"
+#include "Time.h"
+
+#define riseset_step 3600       // bracketing step in seconds
+#define riseset_step_pass 60    // bracketing step for a satellite pass
+#define riseset_step_coarse 600 // first pass step of getRise() for a satellite
+#define riseset_window 86400L   // search window in seconds
+#define riseset_precision 60    // refinement stops within this many seconds
+#define riseset_iterations 8    // maximum refinement evaluations per event
+#define riseset_horizon 0.0     // altitude of rise and set in degrees
+
+/**
+ * Rise, transit and set times of an object, 0 if not within the window
+ */
+struct riseset
+{
+  time_t rise;
+  time_t transit;
+  time_t set;
+};
+
+void getRiseSet(int index, time_t from, double loc_lat_d, double loc_lng_d,
+                double horizon_d, riseset *rs);
+time_t getRise(int index, time_t from, double loc_lat_d, double loc_lng_d,
+               double horizon_d);
+void getRiseSetAll(time_t from, double loc_lat_d, double loc_lng_d,
+                   double horizon_d, riseset *table);
+
+#endif
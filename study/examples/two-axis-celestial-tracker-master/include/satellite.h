@@ -0,0 +1,34 @@
+#ifndef SATELLITE_H
+#define SATELLITE_H
+
+#include <Arduino.h>
+
+#include "debug.h"
+#include "Time.h"
+
+#define satellite_eeprom 16 // EEPROM address of the satellite elements
+#define pass_interval_ms 250 // pointer update interval during a pass
+
+/**
+ * Mean elements of a satellite as given by a TLE
+ */
+struct satellite_elements
+{
+  time_t epoch;      // epoch in UTC, whole seconds
+  double epoch_frac; // fraction of the epoch second
+  double n;          // mean motion in rads per minute
+  double e;          // eccentricity
+  double i;          // inclination in rads
+  double node;       // right ascension of the ascending node in rads
+  double argp;       // argument of perigee in rads
+  double M;          // mean anomaly in rads
+  double bstar;      // drag term in 1 / earth radii
+};
+
+bool satelliteTle(const char *line1, const char *line2, satellite_elements *el);
+void satelliteInit(const satellite_elements *el);
+void satellitePosition(double tsince, double *x, double *y, double *z);
+void getSatellite(time_t now, double *object_ra, double *object_dc, double *object_ro);
+void satelliteSerial();
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef SKYGRID_H
+#define SKYGRID_H
+
+#include <Arduino.h>
+
+#include "debug.h"
+#include "Time.h"
+
+#ifndef skygrid_bands
+#define skygrid_bands 6    // equal area declination bands
+#endif
+#ifndef skygrid_ra_cells
+#define skygrid_ra_cells 6 // right ascension cells per band
+#endif
+#define skygrid_none -1    // no star found
+#define skygrid_near_d 20  // radius in degrees of the search of skySerial()
+
+#define first_star 9 // object index of the first catalog star
+
+/**
+ * A catalog star
+ */
+struct star
+{
+  float ra_h;    // Right Ascention in hours
+  float dc_d;    // Declination in degrees
+  int8_t mag10;  // visual magnitude times 10
+  uint8_t index; // object index as used by getObject
+  uint8_t cell;  // sky grid cell, see skyCell()
+};
+
+int skyCell(double ra_h, double dc_d);
+void getStar(int index, double *object_ra, double *object_dc);
+int skyBrightestNear(double ra_h, double dc_d, double radius_d);
+int skyAboveHorizon(double loc_lat_d, double sidereal_r, double min_al_d,
+                    uint8_t *objects, int max_objects);
+int skyCatalogBrightestNear(const star *catalog, int count,
+                            double ra_h, double dc_d, double radius_d);
+int skyCatalogAboveHorizon(const star *catalog, int count,
+                           double loc_lat_d, double sidereal_r, double min_al_d);
+void skySerial(time_t now, double loc_lat_d, double loc_lng_d, int index);
+
+#endif
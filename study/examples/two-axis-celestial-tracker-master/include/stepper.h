@@ -1,15 +1,62 @@
 #include <Arduino.h>
 
 #include "debug.h"
+#include "motor.h"
 
-#define steps_per_revolution 2048
-#define motor_pin_azimuth 2  // motor driver pins 2-5
-#define motor_pin_altitude 6 // motor driver pins 6-9
-#define step_delay_fast 4    // normaly used
-#define step_delay_slow 20   // calibration
-#define slop_steps 0         // was 25
-#define altitude_limit -200  // lowest step altitude (-35 deg)
+// HALF_STEP drives the ULN2003 boards in half steps, 4096 per revolution,
+// which halves the pointing error. All positions, including those in NVRAM,
+// are in half steps then, so calibrate again after switching
+// #define HALF_STEP
+#ifdef HALF_STEP
+#define step_scale 2 // steps per full step
+#else
+#define step_scale 1
+#endif
+
+#define steps_per_revolution (2048 * step_scale)
+#define motor_pin_azimuth 2                     // motor driver pins 2-5
+#define motor_pin_altitude 6                    // motor driver pins 6-9
+#define step_delay_fast (3000 / step_scale)     // us at cruise, normaly used
+#define step_delay_slow (20000 / step_scale)    // us at cruise, calibration
+#define step_accel_azimuth (1000 * step_scale)  // steps/s/s, carries the altitude motor
+#define step_accel_altitude (2000 * step_scale) // steps/s/s
+#define altitude_limit (-200 * step_scale)      // lowest step altitude (-35 deg)
+#define step_cycle (4 * step_scale)             // steps per coil cycle
+
+// WRAP_360 lets the cable to the altitude motor wrap a full turn either way
+// before the pointer unwinds, instead of half a turn. This saves most unwinds
+// of objects that cross north, but only enable it if the cable survives two
+// full turns end to end
+// #define WRAP_360
+#ifndef wrap_budget
+#ifdef WRAP_360
+#define wrap_budget 360 // degrees the cable may wrap either way
+#else
+#define wrap_budget 180
+#endif
+#endif
+
+// motor drivers, see motor.h. MOTOR_STEP_DIR replaces the ULN2003 boards by
+// step/dir drivers (step, dir and enable pin), steps_per_revolution then
+// depends on the microstepping of the driver
+// #define MOTOR_STEP_DIR
+#ifdef MOTOR_STEP_DIR
+typedef motor_step_dir<2, 3, 4> motor_azimuth;
+typedef motor_step_dir<6, 7, 8> motor_altitude;
+#elif defined(HALF_STEP)
+typedef motor_uln2003<motor_pin_azimuth, uln2003_half_step> motor_azimuth;
+typedef motor_uln2003<motor_pin_altitude, uln2003_half_step> motor_altitude;
+#else
+typedef motor_uln2003<motor_pin_azimuth, uln2003_full_step> motor_azimuth;
+typedef motor_uln2003<motor_pin_altitude, uln2003_full_step> motor_altitude;
+#endif
 
 void set_step_delay(unsigned long delay);
+void step_begin();
 void step_to(int new_position_azimuth, int new_position_altitude, bool calibrating);
-void step_energize(int motor_pin_first, int mode);
+int step_wrap(int az_ticks, int from_ticks);
+void set_backlash(int axis, int steps);
+int get_backlash(int axis);
+#ifdef MOTOR_BENCH
+void step_bench();
+#endif
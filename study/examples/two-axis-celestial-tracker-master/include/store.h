@@ -0,0 +1,25 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <Arduino.h>
+
+#include "debug.h"
+
+// keys of the non volatile store, the type of each key is fixed in store.cpp
+#define store_azimuth 0  // int16, motor position
+#define store_altitude 1 // int16, motor position
+#define store_backlash 2 // uint8, azimuth motor, store_backlash + 1 altitude
+#define store_object 4   // uint8, object index
+#define store_location 5 // uint8, location index
+#define store_aging 6    // int8, aging offset of the RTC
+#define store_keys 7
+
+#define store_eeprom 4 // EEPROM address of the settings on a DS3231
+
+int store_get(uint8_t key);
+void store_set(uint8_t key, int value);
+void store_flush();
+boolean store_sram();
+void store_alarm(uint8_t minute, uint8_t hour);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <Arduino.h>
+
+#include "debug.h"
+#include "Time.h"
+
+#define trajectory_events 16        // events compiled ahead
+#define trajectory_min_interval 40  // seconds, closer steps are merged
+#define trajectory_max_interval 3600 // seconds, wake at least this often
+#define trajectory_scan 900         // seconds between scan samples at most
+#define trajectory_margin 1.25      // sample past the predicted step by this factor
+
+/**
+ * Pointer position due at a wake up time
+ */
+struct trajectory_event
+{
+  time_t wake;
+  int az;
+  int al;
+};
+
+void trajectory_start(time_t t, double loc_lng_d);
+void trajectory_clear();
+bool trajectory_pop(time_t t, int *az_ticks, int *al_ticks);
+time_t trajectory_wake();
+
+#endif
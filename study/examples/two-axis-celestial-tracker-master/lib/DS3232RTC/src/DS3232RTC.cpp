@@ -17,6 +17,18 @@
 // DS3232RTC::begin(). The constructor has an optional bool parameter
 // to indicate whether I2C initialization should occur in the
 // constructor; this parameter defaults to true if not given.
+//
+// With cache(true) the registers 0x00-0x12 are kept in a RAM shadow.
+// The first read fetches all of them in one burst, further reads of
+// the alarm, control, aging and temperature registers come from RAM.
+// Reading the time always fetches the whole block again, so the time is
+// never stale. Writes to the alarm, control and aging registers only
+// change the shadow, flush() writes them back with one burst per run of
+// consecutive registers. The status register is not cached, as the RTC
+// sets its flags by itself: it is always read from the RTC, and its flags
+// are cleared by writing a zero to the flag being cleared only. cache(false) flushes and
+// drops the shadow, e.g. before the RTC is powered down. The number of
+// I2C transactions is counted in transactions.
 
 // define release-independent I2C functions
 #if defined(__AVR_ATtiny44__) || defined(__AVR_ATtiny84__) || defined(__AVR_ATtiny45__) || defined(__AVR_ATtiny85__)
@@ -73,6 +85,7 @@
 #define RTC_TEMP_LSB 0x12
 #define SRAM_START_ADDR 0x14    // first SRAM address
 #define SRAM_SIZE 236           // number of bytes of SRAM
+#define RTC_REGS 0x13           // number of registers in the shadow
 
 // Alarm mask bits
 #define A1M1 7
@@ -102,6 +115,7 @@
 #define BSY 2
 #define A2F 1
 #define A1F 0
+#define FLAGS (_BV(OSF) | _BV(A2F) | _BV(A1F)) // writing a one leaves them
 
 // Other
 #define DS1307_CH 7                // for DS1307 compatibility, Clock Halt bit in Seconds register
@@ -110,6 +124,17 @@
 #define DYDT 6                     // Day/Date flag bit in alarm Day/Date registers
 
 byte DS3232RTC::errCode;           // for debug
+uint16_t DS3232RTC::transactions;
+bool DS3232RTC::cacheEnabled;
+bool DS3232RTC::shadowValid;
+uint8_t DS3232RTC::shadow[RTC_REGS];
+uint32_t DS3232RTC::dirty;         // bit per register written in the shadow only
+
+// True if a range of registers is in the shadow, the status register is not
+static bool cached(byte addr, byte nBytes)
+{
+    return addr + nBytes <= RTC_STATUS || (addr > RTC_STATUS && addr + nBytes <= RTC_REGS);
+}
 
 // Constructor. Initializes the I2C bus by default, but better
 // practice is to pass false in the constructor and call
@@ -151,18 +176,32 @@ byte DS3232RTC::set(time_t t)
 // structure. Returns the I2C status (zero if successful).
 byte DS3232RTC::read(tmElements_t &tm)
 {
-    i2cBeginTransmission(RTC_ADDR);
-    i2cWrite((uint8_t)RTC_SECONDS);
-    if ( byte e = i2cEndTransmission() ) { errCode = e; return e; }
-    // request 7 bytes (secs, min, hr, dow, date, mth, yr)
-    i2cRequestFrom(RTC_ADDR, tmNbrFields);
-    tm.Second = bcd2dec(i2cRead() & ~_BV(DS1307_CH));
-    tm.Minute = bcd2dec(i2cRead());
-    tm.Hour = bcd2dec(i2cRead() & ~_BV(HR1224));    // assumes 24hr clock
-    tm.Wday = i2cRead();
-    tm.Day = bcd2dec(i2cRead());
-    tm.Month = bcd2dec(i2cRead() & ~_BV(CENTURY));  // don't use the Century bit
-    tm.Year = y2kYearToTm(bcd2dec(i2cRead()));
+    uint8_t r[tmNbrFields];
+
+    if (cacheEnabled)
+    {
+        // the other registers come along with the time
+        if ( byte e = refresh() ) return e;
+        for (byte i=0; i<tmNbrFields; i++) r[i] = shadow[RTC_SECONDS + i];
+    }
+    else
+    {
+        i2cBeginTransmission(RTC_ADDR);
+        i2cWrite((uint8_t)RTC_SECONDS);
+        transactions++;
+        if ( byte e = i2cEndTransmission() ) { errCode = e; return e; }
+        // request 7 bytes (secs, min, hr, dow, date, mth, yr)
+        transactions++;
+        i2cRequestFrom(RTC_ADDR, tmNbrFields);
+        for (byte i=0; i<tmNbrFields; i++) r[i] = i2cRead();
+    }
+    tm.Second = bcd2dec(r[0] & ~_BV(DS1307_CH));
+    tm.Minute = bcd2dec(r[1]);
+    tm.Hour = bcd2dec(r[2] & ~_BV(HR1224));    // assumes 24hr clock
+    tm.Wday = r[3];
+    tm.Day = bcd2dec(r[4]);
+    tm.Month = bcd2dec(r[5] & ~_BV(CENTURY));  // don't use the Century bit
+    tm.Year = y2kYearToTm(bcd2dec(r[6]));
     return 0;
 }
 
@@ -180,9 +219,10 @@ byte DS3232RTC::write(tmElements_t &tm)
     i2cWrite(dec2bcd(tm.Day));
     i2cWrite(dec2bcd(tm.Month));
     i2cWrite(dec2bcd(tmYearToY2k(tm.Year)));
+    transactions++;
     byte ret = i2cEndTransmission();
-    uint8_t s = readRTC(RTC_STATUS);        // read the status register
-    writeRTC( RTC_STATUS, s & ~_BV(OSF) );  // clear the Oscillator Stop Flag
+    shadowValid = false;                    // the time in the shadow is old
+    clearFlags( _BV(OSF) );                 // clear the Oscillator Stop Flag
     return ret;
 }
 
@@ -191,11 +231,26 @@ byte DS3232RTC::write(tmElements_t &tm)
 // Number of bytes (nBytes) must be between 1 and 31 (Wire library
 // limitation).
 // Returns the I2C status (zero if successful).
+// With the cache enabled, the alarm, control and aging registers are
+// written by flush().
 byte DS3232RTC::writeRTC(byte addr, byte *values, byte nBytes)
 {
+    bool shadowOnly = cacheEnabled && addr >= ALM1_SECONDS && cached(addr, nBytes);
+
+    for (byte i=0; i<nBytes && addr + i < RTC_REGS; i++)
+    {
+        shadow[addr + i] = values[i];
+        if (shadowOnly)
+            dirty |= 1ul << (addr + i);
+        else
+            dirty &= ~(1ul << (addr + i));
+    }
+    if (shadowOnly) return 0;
+
     i2cBeginTransmission(RTC_ADDR);
     i2cWrite(addr);
     for (byte i=0; i<nBytes; i++) i2cWrite(values[i]);
+    transactions++;
     return i2cEndTransmission();
 }
 
@@ -212,11 +267,23 @@ byte DS3232RTC::writeRTC(byte addr, byte value)
 // Number of bytes (nBytes) must be between 1 and 32 (Wire library
 // limitation).
 // Returns the I2C status (zero if successful).
+// With the cache enabled, registers 0x00-0x12 but the status register are
+// read from the shadow.
 byte DS3232RTC::readRTC(byte addr, byte *values, byte nBytes)
 {
+    if (cacheEnabled && cached(addr, nBytes))
+    {
+        if (!shadowValid)
+            if ( byte e = refresh() ) return e;
+        for (byte i=0; i<nBytes; i++) values[i] = shadow[addr + i];
+        return 0;
+    }
+
     i2cBeginTransmission(RTC_ADDR);
     i2cWrite(addr);
+    transactions++;
     if ( byte e = i2cEndTransmission() ) return e;
+    transactions++;
     i2cRequestFrom( (uint8_t)RTC_ADDR, nBytes );
     for (byte i=0; i<nBytes; i++) values[i] = i2cRead();
     return 0;
@@ -302,8 +369,7 @@ bool DS3232RTC::alarm(byte alarmNumber)
     mask = _BV(A1F) << (alarmNumber - 1);
     if (statusReg & mask)
     {
-        statusReg &= ~mask;
-        writeRTC(RTC_STATUS, statusReg);
+        clearFlags(mask);
         return true;
     }
     else
@@ -340,7 +406,7 @@ bool DS3232RTC::oscStopped(bool clearOSF)
     bool ret = s & _BV(OSF);            // isolate the osc stop flag to return to caller
     if (ret && clearOSF)                // clear OSF if it's set and the caller wants to clear it
     {
-        writeRTC( RTC_STATUS, s & ~_BV(OSF) );
+        clearFlags( _BV(OSF) );
     }
     return ret;
 }
@@ -358,6 +424,69 @@ int DS3232RTC::temperature()
     return rtcTemp.i / 64;
 }
 
+// Clear flags in the status register. The other flags are written as
+// ones, which leaves them as they are, so a flag the RTC sets between
+// the read and the write is not lost.
+// Returns the I2C status (zero if successful).
+byte DS3232RTC::clearFlags(byte mask)
+{
+    return writeRTC( RTC_STATUS, (readRTC(RTC_STATUS) | FLAGS) & ~mask );
+}
+
+// Enable or disable the register shadow. Both write back the registers
+// that changed and drop the shadow, so the next read fetches the
+// registers again.
+void DS3232RTC::cache(bool enable)
+{
+    flush();
+    shadowValid = false;
+    cacheEnabled = enable;
+}
+
+// Read registers 0x00-0x12 into the shadow in one burst. Registers
+// that were written to the shadow but not yet flushed keep their value.
+// Returns the I2C status (zero if successful).
+byte DS3232RTC::refresh()
+{
+    i2cBeginTransmission(RTC_ADDR);
+    i2cWrite((uint8_t)RTC_SECONDS);
+    transactions++;
+    if ( byte e = i2cEndTransmission() ) { errCode = e; return e; }
+    transactions++;
+    i2cRequestFrom( (uint8_t)RTC_ADDR, (uint8_t)RTC_REGS );
+    for (byte i=0; i<RTC_REGS; i++)
+    {
+        uint8_t b = i2cRead();
+        if ( !(dirty & 1ul << i) ) shadow[i] = b;
+    }
+    shadowValid = true;
+    return 0;
+}
+
+// Write the registers that changed in the shadow, one burst for every
+// run of consecutive registers.
+// Returns the I2C status (zero if successful).
+byte DS3232RTC::flush()
+{
+    byte ret = 0;
+    byte addr = ALM1_SECONDS;
+
+    while (dirty)
+    {
+        while ( !(dirty & 1ul << addr) ) addr++;
+        i2cBeginTransmission(RTC_ADDR);
+        i2cWrite(addr);
+        while (dirty & 1ul << addr)
+        {
+            i2cWrite(shadow[addr]);
+            dirty &= ~(1ul << addr++);
+        }
+        transactions++;
+        if ( byte e = i2cEndTransmission() ) ret = e;
+    }
+    return ret;
+}
+
 // Decimal-to-BCD conversion
 uint8_t DS3232RTC::dec2bcd(uint8_t n)
 {
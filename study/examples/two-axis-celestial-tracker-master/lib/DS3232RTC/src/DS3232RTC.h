@@ -71,11 +71,20 @@ class DS3232RTC
         void squareWave(SQWAVE_FREQS_t freq);
         bool oscStopped(bool clearOSF = false);
         int temperature();
+        void cache(bool enable);
+        static byte refresh();
+        byte flush();
         static byte errCode;
+        static uint16_t transactions;   // I2C transactions, for benchmarks
 
     private:
         uint8_t dec2bcd(uint8_t n);
         static uint8_t bcd2dec(uint8_t n);
+        byte clearFlags(byte mask);
+        static bool cacheEnabled;
+        static bool shadowValid;
+        static uint8_t shadow[];
+        static uint32_t dirty;
 };
 
 #ifdef ARDUINO_ARCH_AVR
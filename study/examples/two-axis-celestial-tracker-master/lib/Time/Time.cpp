@@ -143,93 +143,77 @@ int year(time_t t) { // the year for the given time
 /* functions to convert to and from system time */
 /* These are for interfacing with time serivces and are not normally needed in a sketch */
 
-// leap year calulator expects year argument as years offset from 1970
-#define LEAP_YEAR(Y)     ( ((1970+Y)>0) && !((1970+Y)%4) && ( ((1970+Y)%100) || !((1970+Y)%400) ) )
+// dates are counted from 1 March 1968: the leap day is the last day of every
+// 4 year cycle, and a year from March on has its months at a fixed 153 days
+// per 5 months. 2100 is the only year in the range of time_t that is not a
+// leap year, its missing 29 February is skipped.
+#define DAYS_PER_CYCLE   1461   // days in 4 years
+#define DAYS_TO_1970     671    // days from 1 March 1968 to 1 January 1970
+#define DAYS_TO_2100     48212  // days from 1 March 1968 to 1 March 2100
 
-static  const uint8_t monthDays[]={31,28,31,30,31,30,31,31,30,31,30,31}; // API starts months from 1, this array starts from 0
- 
 void breakTime(time_t timeInput, tmElements_t &tm){
 // break the given time_t into time components
 // this is a more compact version of the C library localtime function
 // note that year is offset from 1970 !!!
+// takes the same steps for any date, without a loop over the years
 
-  uint8_t year;
-  uint8_t month, monthLength;
+  uint8_t cycle, year, month;
+  uint16_t days, seconds;
   uint32_t time;
-  unsigned long days;
 
   time = (uint32_t)timeInput;
-  tm.Second = time % 60;
-  time /= 60; // now it is minutes
-  tm.Minute = time % 60;
-  time /= 60; // now it is hours
-  tm.Hour = time % 24;
-  time /= 24; // now it is days
-  tm.Wday = ((time + 4) % 7) + 1;  // Sunday is day 1 
-  
-  year = 0;  
-  days = 0;
-  while((unsigned)(days += (LEAP_YEAR(year) ? 366 : 365)) <= time) {
-    year++;
+  days = time / SECS_PER_DAY;
+  time -= days * SECS_PER_DAY; // now it is seconds of the day
+  tm.Hour = time / SECS_PER_HOUR;
+  seconds = time - tm.Hour * SECS_PER_HOUR; // now it is seconds of the hour
+  tm.Minute = seconds / 60;
+  tm.Second = seconds - tm.Minute * 60;
+  tm.Wday = ((days + 4) % 7) + 1;  // Sunday is day 1
+
+  days += DAYS_TO_1970;
+  if (days >= DAYS_TO_2100) {
+    days++; // skip 29 February 2100
   }
-  tm.Year = year; // year is offset from 1970 
-  
-  days -= LEAP_YEAR(year) ? 366 : 365;
-  time  -= days; // now it is days in this year, starting at 0
-  
-  days=0;
-  month=0;
-  monthLength=0;
-  for (month=0; month<12; month++) {
-    if (month==1) { // february
-      if (LEAP_YEAR(year)) {
-        monthLength=29;
-      } else {
-        monthLength=28;
-      }
-    } else {
-      monthLength = monthDays[month];
-    }
-    
-    if (time >= monthLength) {
-      time -= monthLength;
-    } else {
-        break;
-    }
+  cycle = days / DAYS_PER_CYCLE;
+  days -= (uint16_t)cycle * DAYS_PER_CYCLE; // now it is days in the cycle
+  year = days / 365;
+  if (year > 3) {
+    year = 3; // the leap day
   }
-  tm.Month = month + 1;  // jan is month 1  
-  tm.Day = time + 1;     // day of month
+  days -= (uint16_t)year * 365; // now it is days since 1 March
+  month = (5 * days + 2) / 153; // March is month 0
+  tm.Day = days - (153 * month + 2) / 5 + 1; // day of month
+  month = month < 10 ? month + 3 : month - 9;
+  tm.Month = month;  // jan is month 1
+  tm.Year = 4 * cycle + year + (month <= 2) - 2; // year is offset from 1970
 }
 
 time_t makeTime(tmElements_t &tm){   
 // assemble time elements into time_t 
 // note year argument is offset from 1970 (see macros in time.h to convert to other formats)
 // previous version used full four digit year (or digits since 2000),i.e. 2009 was 2009 or 9
-  
-  int i;
-  uint32_t seconds;
-
-  // seconds from 1970 till 1 jan 00:00:00 of the given year
-  seconds= tm.Year*(SECS_PER_DAY * 365);
-  for (i = 0; i < tm.Year; i++) {
-    if (LEAP_YEAR(i)) {
-      seconds +=  SECS_PER_DAY;   // add extra days for leap years
-    }
+// takes the same steps for any date, without a loop over the years
+
+  uint8_t year, month;
+  uint16_t days;
+
+  // years from 1 March 1968 and months from March
+  year = tm.Year + 2;
+  month = tm.Month;
+  if (month <= 2) {
+    year--;
+    month += 9;
+  } else {
+    month -= 3;
   }
-  
-  // add days for this year, months start from 1
-  for (i = 1; i < tm.Month; i++) {
-    if ( (i == 2) && LEAP_YEAR(tm.Year)) { 
-      seconds += SECS_PER_DAY * 29;
-    } else {
-      seconds += SECS_PER_DAY * monthDays[i-1];  //monthDay array starts from 0
-    }
+
+  days = (uint16_t)year * 365 + year / 4 + (153 * month + 2) / 5 + tm.Day - 1;
+  if (year >= 2100 - 1968) {
+    days--; // 2100 has no 29 February
   }
-  seconds+= (tm.Day-1) * SECS_PER_DAY;
-  seconds+= tm.Hour * SECS_PER_HOUR;
-  seconds+= tm.Minute * SECS_PER_MIN;
-  seconds+= tm.Second;
-  return (time_t)seconds; 
+  days -= DAYS_TO_1970;
+
+  return (time_t)(days * SECS_PER_DAY + tm.Hour * SECS_PER_HOUR + tm.Minute * SECS_PER_MIN + tm.Second);
 }
 /*=====================================================*/	
 /* Low level system time functions  */
@@ -0,0 +1,329 @@
+/**
+ * @file aging.cpp
+ * @brief Calibrates the aging register of the RTC against a reference
+ *
+ * The DS3231 compensates its crystal for temperature, but what is left is a
+ * drift of a few ppm, which depends on the temperature as well. A drift of
+ * 2 ppm is 5 s a month, 75" of sidereal angle, more than a motor step.
+ *
+ * A correction compares the RTC with a reference, to a few ms:
+ * - a line "t seconds since 1970" on Serial at start up, sent at the start
+ *   of that second, e.g. by date +t%s after waiting for the second
+ * - with AGING_PULSE, a pulse at the start of every second on
+ *   aging_pulse_pin, measured every aging_pulse_interval
+ * The millis() from the reference to the next tick of the RTC give the
+ * fraction of the second.
+ *
+ * Every wake up sums the temperature and the aging register over time, the
+ * temperature is read every aging_temperature_interval. When the last
+ * correction is at least aging_min_interval ago, the drift since then
+ * becomes a sample, with the mean temperature and corrected to aging 0. A
+ * line rate = a + b * temperature is fitted to the samples, weighted by
+ * their length; the slope only when the temperatures are at least 1 C apart.
+ * Every aging_save_interval the aging register is set to cancel the fitted
+ * drift at the temperature of the last day. One step of the aging register
+ * is about 0.1 ppm, a positive value slows the clock.
+ *
+ * The samples and sums are kept in EEPROM, the aging in the store.
+ *
+ * aging_sum(), aging_sample_add(), aging_fit() and aging_target() only need
+ * math.h, so they can be compiled on a host as well, e.g. by the fitting
+ * test in tools/agingfit.cpp.
+ */
+
+#include "aging.h"
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * Sum the temperature and the aging register over an interval
+ * @param [in,out] st state
+ * @param [in] seconds length of the interval
+ * @param [in] temperature 0.25 C
+ * @param [in] aging register
+ */
+void aging_sum(aging_state *st, float seconds, int temperature, int aging)
+{
+	st->seconds += seconds;
+	st->temperature_sum += temperature * seconds;
+	st->aging_sum += aging * seconds;
+}
+
+/**
+ * A reference found the RTC ahead by error_ms. The drift since the last
+ * reference becomes a sample, corrected to aging 0, and the sums start again.
+ * @param [in,out] st state
+ * @param [in] t time of the reference
+ * @param [in] error_ms RTC ahead of the reference
+ */
+void aging_sample_add(aging_state *st, time_t t, long error_ms)
+{
+	if (st->since && st->seconds > 0.0)
+	{
+		float seconds = t - st->since;
+		float rate = (error_ms - st->error_ms) * 1e5 / seconds +
+					 st->aging_sum / st->seconds * aging_lsb;
+		if (fabs(rate) < 2000.0) // not a missed second
+		{
+			aging_sample *s = &st->samples[st->next];
+			s->rate = lround(rate);
+			s->temperature = lround(st->temperature_sum / st->seconds);
+			s->hours = seconds / 3600.0;
+			st->next = (st->next + 1) % aging_samples;
+			if (st->count < aging_samples)
+				st->count++;
+		}
+	}
+	st->since = t;
+	st->error_ms = error_ms;
+	st->seconds = 0.0;
+	st->temperature_sum = 0.0;
+	st->aging_sum = 0.0;
+}
+
+/**
+ * Fit the drift to the samples and evaluate it, within the temperatures of
+ * the samples
+ * @param [in] st state, with at least one sample
+ * @param [in] temperature 0.25 C
+ * @returns drift at aging 0 in 0.01 ppm
+ */
+float aging_fit(const aging_state *st, float temperature)
+{
+	float w = 0.0;
+	float wt = 0.0;
+	float wr = 0.0;
+	float low = 1e6;
+	float high = -1e6;
+
+	for (uint8_t n = 0; n < st->count; n++)
+	{
+		const aging_sample *s = &st->samples[n];
+		w += s->hours;
+		wt += (float)s->hours * s->temperature;
+		wr += (float)s->hours * s->rate;
+		if (s->temperature < low)
+			low = s->temperature;
+		if (s->temperature > high)
+			high = s->temperature;
+	}
+	float tm = wt / w;
+	float rm = wr / w;
+
+	float stt = 0.0;
+	float str = 0.0;
+	for (uint8_t n = 0; n < st->count; n++)
+	{
+		const aging_sample *s = &st->samples[n];
+		float dt = s->temperature - tm;
+		stt += s->hours * dt * dt;
+		str += s->hours * dt * (s->rate - rm);
+	}
+	if (stt < 16.0 * w) // spread below 1 C
+		return rm;
+	if (temperature < low)
+		temperature = low;
+	else if (temperature > high)
+		temperature = high;
+	return rm + str / stt * (temperature - tm);
+}
+
+/**
+ * The aging register that cancels the drift at a temperature, with some
+ * hysteresis
+ * @param [in] st state
+ * @param [in] temperature 0.25 C
+ * @param [in] aging register now
+ * @returns aging register
+ */
+int aging_target(const aging_state *st, float temperature, int aging)
+{
+	if (st->count == 0)
+		return aging;
+
+	float target = aging_fit(st, temperature) / aging_lsb;
+	if (fabs(target - aging) <= 0.75)
+		return aging;
+	if (target < -127.0)
+		return -127;
+	if (target > 127.0)
+		return 127;
+	return lround(target);
+}
+
+#ifdef ARDUINO
+#include "main.h"
+#include <EEPROM.h>
+
+#define AGING 0x10 // aging register
+
+static aging_state state;
+static boolean state_loaded = false;
+static time_t update_last = 0;		// last aging_update()
+static time_t save_last = 0;		// last save of the state
+static float temperature_recent;	// about the last day, 0.25 C
+static int temperature;				// last read, 0.25 C
+static time_t temperature_last = 0; // last read of the temperature
+#ifdef AGING_PULSE
+static time_t pulse_last = 0;		// last pulse measurement
+#endif
+
+static void aging_load()
+{
+	if (!state_loaded)
+	{
+		EEPROM.get(aging_eeprom, state);
+		if (state.count > aging_samples || state.next >= aging_samples || !(state.seconds >= 0.0))
+			memset(&state, 0, sizeof(state)); // never written
+		state_loaded = true;
+	}
+}
+
+/**
+ * Set the aging register to cancel the drift at a temperature
+ * @param [in] temperature 0.25 C
+ */
+static void aging_apply(float temperature)
+{
+	int aging = store_get(store_aging);
+	int target = aging_target(&state, temperature, aging);
+
+	if (target != aging)
+	{
+		store_set(store_aging, target);
+		RTC.writeRTC(AGING, (uint8_t)target);
+	}
+}
+
+/**
+ * Wait for the next tick of the RTC
+ * @param [in] me millis() at the reference
+ * @param [out] rtc the RTC second at the reference
+ * @returns ms of that second at the reference
+ */
+static long aging_phase(unsigned long me, time_t *rtc)
+{
+	time_t s = RTC.get();
+
+	while (RTC.get() == s && millis() - me < 1100)
+	{
+	}
+	*rtc = s;
+	return 1000 - (long)(millis() - me);
+}
+
+#ifdef AGING_PULSE
+/**
+ * Measure the RTC against the rising edge of the pulse. Only the fraction
+ * of the second is known, the error is taken closest to the last one.
+ * @param [out] error_ms RTC ahead of the pulse
+ * @returns false if no pulse arrived
+ */
+static boolean aging_pulse(long *error_ms)
+{
+	unsigned long start = millis();
+	time_t rtc;
+
+	pinMode(aging_pulse_pin, INPUT);
+	while (digitalRead(aging_pulse_pin))
+		if (millis() - start > 1100)
+			return false;
+	while (!digitalRead(aging_pulse_pin))
+		if (millis() - start > 2100)
+			return false;
+
+	long e = aging_phase(millis(), &rtc);
+	*error_ms = e + 1000 * lround((state.error_ms - e) / 1000.0);
+	return true;
+}
+#endif
+
+/**
+ * Sum the temperature and aging, measure the pulse and set the aging
+ * register when due. Called every wake up.
+ * @param [in] t now
+ */
+void aging_update(time_t t)
+{
+	aging_load();
+
+	if (update_last == 0 || t - temperature_last >= aging_temperature_interval)
+	{
+		temperature = RTC.temperature();
+		temperature_last = t;
+	}
+	if (update_last == 0)
+		temperature_recent = temperature;
+	else if (t > update_last)
+	{
+		float dt = t - update_last;
+		temperature_recent += (temperature - temperature_recent) * dt / (dt + 86400.0);
+		if (state.since)
+			aging_sum(&state, dt, temperature, store_get(store_aging));
+	}
+	update_last = t;
+
+#ifdef AGING_PULSE
+	long error_ms;
+	if (t - pulse_last >= aging_pulse_interval && aging_pulse(&error_ms))
+	{
+		pulse_last = t;
+		aging_correct(t, error_ms, 0);
+	}
+#endif
+
+	if (t - save_last >= aging_save_interval)
+	{
+		save_last = t;
+		aging_apply(temperature_recent);
+		EEPROM.put(aging_eeprom, state);
+	}
+}
+
+/**
+ * A reference found the RTC ahead by error_ms. The drift since the last
+ * correction becomes a sample, unless that is less than aging_min_interval
+ * ago, and the aging is fitted again.
+ * @param [in] t time of the reference
+ * @param [in] error_ms RTC ahead of the reference
+ * @param [in] step_ms the caller steps the RTC back by this much
+ */
+void aging_correct(time_t t, long error_ms, long step_ms)
+{
+	aging_load();
+
+	if (state.since == 0 || t - state.since >= aging_min_interval)
+	{
+		aging_sample_add(&state, t, error_ms);
+		aging_apply(update_last ? temperature_recent : RTC.temperature());
+	}
+	state.error_ms -= step_ms;
+	EEPROM.put(aging_eeprom, state);
+}
+
+#ifdef SERIAL_BPS
+/**
+ * Read reference times from Serial, see above, and step the RTC by whole
+ * seconds to it. Reading stops when nothing arrives for a few seconds.
+ */
+void agingSerial()
+{
+	Serial.setTimeout(5000);
+	while (Serial.find((char *)"t"))
+	{
+		time_t reference = Serial.parseInt();
+		unsigned long me = millis();
+		time_t rtc;
+		long error_ms = aging_phase(me, &rtc);
+
+		error_ms += (long)(rtc - reference) * 1000;
+		long step_ms = (error_ms + (error_ms < 0 ? -500 : 500)) / 1000 * 1000;
+		if (step_ms)
+			RTC.set(rtc + 1 - step_ms / 1000); // just after the tick
+		aging_correct(reference, error_ms, step_ms);
+		Serial.println(error_ms);
+	}
+}
+#endif
+#endif
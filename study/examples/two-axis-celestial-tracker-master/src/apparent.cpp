@@ -0,0 +1,134 @@
+/**
+ * @file apparent.cpp
+ * @brief Apparent place corrections between catalog coordinates and transform()
+ *
+ * The stages are applied in the order of the reduction from a mean catalog
+ * place to an apparent topocentric place:
+ * - precession, catalog stars only (J2000 to equinox of date)
+ * - nutation
+ * - annual aberration, not for the satellite, which moves with the earth
+ * - refraction, applied to the altitude after transform()
+ *
+ * Which stages are compiled is set in apparent.h. All math is taken from
+ * Jean Meeus, Astronomical Algorithms, 2nd ed., chapters 16, 21, 22 and 23,
+ * using the low accuracy series, good to about 1". Example 23.a of that book
+ * (theta Persei on 2028-11-13) is the reference for nutation and aberration.
+ */
+
+#include "apparent.h"
+
+#include "astronomy.h"
+#include "skygrid.h"
+
+#define arcsec_r (pi / 648000.0) // one arc second in rads
+
+#if defined(APPARENT_PRECESSION) || defined(APPARENT_NUTATION) || defined(APPARENT_ABERRATION)
+/**
+ * Apply the apparent place stages to the catalog or computed coordinates
+ * @param [in] index of the object, precession is applied to stars only and
+ * aberration not to the satellite
+ * @param [in] now current time in UTC
+ * @param [in,out] object_ra Right Ascention in hours
+ * @param [in,out] object_dc Declination in degrees
+ */
+void apparentPlace(int index, time_t now, double *object_ra, double *object_dc)
+{
+	double T = (now - secs_j2000) / secs_per_century; // julian centuries since J2000
+	double ra = *object_ra / 12.0 * pi;
+	double dc = *object_dc / 180.0 * pi;
+
+#ifdef APPARENT_PRECESSION
+	// rigorous precession, Meeus 21.2 and 21.4
+	if (index >= first_star && index <= last_star)
+	{
+		double zeta = (2306.2181 + (0.30188 + 0.017998 * T) * T) * T * arcsec_r;
+		double z = (2306.2181 + (1.09468 + 0.018203 * T) * T) * T * arcsec_r;
+		double theta = (2004.3109 - (0.42665 + 0.041833 * T) * T) * T * arcsec_r;
+
+		double A = cos(dc) * sin(ra + zeta);
+		double B = cos(theta) * cos(dc) * cos(ra + zeta) - sin(theta) * sin(dc);
+		double C = sin(theta) * cos(dc) * cos(ra + zeta) + cos(theta) * sin(dc);
+
+		ra = atan2(A, B) + z;
+		dc = atan2(C, sqrt(A * A + B * B));
+	}
+#endif
+
+#if defined(APPARENT_NUTATION) || defined(APPARENT_ABERRATION)
+	double ecl = (84381.448 - 46.815 * T) * arcsec_r; // mean obliquity, Meeus 22.2
+#endif
+
+#ifdef APPARENT_NUTATION
+	{
+		// nutation in longitude and obliquity, Meeus chapter 22
+		double omega = (125.04452 - 1934.136261 * T) / 180.0 * pi; // moon's node
+		double Lsun = (280.4665 + 36000.7698 * T) / 180.0 * pi;	   // mean longitude sun
+		double Lmoon = (218.3165 + 481267.8813 * T) / 180.0 * pi;  // mean longitude moon
+
+		double dpsi = (-17.20 * sin(omega) - 1.32 * sin(2 * Lsun) -
+					   0.23 * sin(2 * Lmoon) + 0.21 * sin(2 * omega)) *
+					  arcsec_r;
+		double deps = (9.20 * cos(omega) + 0.57 * cos(2 * Lsun) +
+					   0.10 * cos(2 * Lmoon) - 0.09 * cos(2 * omega)) *
+					  arcsec_r;
+
+		// Meeus 23.1
+		double dra = (cos(ecl) + sin(ecl) * sin(ra) * tan(dc)) * dpsi - cos(ra) * tan(dc) * deps;
+		double ddc = sin(ecl) * cos(ra) * dpsi + sin(ra) * deps;
+		ecl += deps; // true obliquity for the aberration
+		ra += dra;
+		dc += ddc;
+	}
+#endif
+
+#ifdef APPARENT_ABERRATION
+#ifdef SATELLITE
+	if (index != object_satellite)
+#endif
+	{
+		// true longitude of the sun, Meeus chapter 25 low accuracy
+		double M = (357.52911 + 35999.05029 * T) / 180.0 * pi;
+		double sun = (280.46646 + 36000.76983 * T +
+					  (1.914602 - 0.004817 * T) * sin(M) + 0.019993 * sin(2 * M)) /
+					 180.0 * pi;
+		double kappa = 20.49552 * arcsec_r; // constant of aberration
+
+		// Meeus 23.3, without the e-terms
+		double dra = -kappa * (cos(ra) * cos(sun) * cos(ecl) + sin(ra) * sin(sun)) / cos(dc);
+		double ddc = -kappa * (cos(sun) * cos(ecl) * (tan(ecl) * cos(dc) - sin(ra) * sin(dc)) +
+							   cos(ra) * sin(dc) * sin(sun));
+		ra += dra;
+		dc += ddc;
+	}
+#endif
+
+	*object_ra = ra * 12.0 / pi;
+	if (*object_ra < 0.0)
+		*object_ra += 24.0;
+	else if (*object_ra >= 24.0)
+		*object_ra -= 24.0;
+	*object_dc = dc * 180.0 / pi;
+}
+#endif
+
+#ifdef APPARENT_REFRACTION
+/**
+ * Atmospheric refraction for 10 degrees C and 1010 hPa, Saemundsson's formula
+ * (Meeus 16.4). Below one degree under the horizon the object is not visible
+ * anyway and the formula runs off, so from there the correction of 39' is
+ * tapered to zero at two degrees under the horizon. The pointer then moves
+ * smoothly through, instead of jumping at a cut off.
+ * @param [in] object_al_d true altitude in degrees
+ * @returns apparent altitude in degrees
+ */
+double apparentAltitude(double object_al_d)
+{
+	if (object_al_d <= -2.0)
+		return object_al_d;
+	double h = object_al_d < -1.0 ? -1.0 : object_al_d;
+	double R = 1.02 / tan((h + 10.3 / (h + 5.11)) / 180.0 * pi); // arcmin
+	if (object_al_d < -1.0)
+		R *= object_al_d + 2.0; // taper
+	return object_al_d + R / 60.0;
+}
+#endif
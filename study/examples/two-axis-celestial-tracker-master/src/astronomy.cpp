@@ -15,6 +15,192 @@
 
 #include "astronomy.h"
 
+#include "fasttrig.h"
+#include "skygrid.h"
+#include "apparent.h"
+#include "satellite.h"
+
+/**
+ * An orbital element as base + rate * d, both in rads (AU or earth radii
+ * for the distance)
+ */
+struct element
+{
+	double base;
+	double rate;
+};
+
+/**
+ * Orbital elements of Mercury to Neptune, object 1 to 8, in the order
+ * No, io, wo, ao, eco and Mo. The original degrees are in the comments.
+ * http://www.stjarnhimlen.se/comp/ppcomp.html#4
+ */
+static const element elements[8][6] PROGMEM = {
+	{
+		// Mercury
+		{0.843540316769135, 5.665111859171E-7},	 // 48.3313 + 3.24587E-5 * d
+		{0.122255078114447, 8.726646259972E-10}, //  7.0047 + 5.00E-8 * d
+		{0.508311436680081, 1.770531806393E-7},	 // 29.1241 + 1.01444E-5 * d
+		{0.387098, 0.0},						 // (AU)
+		{0.205635, 5.59E-10},
+		{2.94360599390206, 7.142471001491E-2}, // 168.6562 + 4.0923344368 * d
+	},
+	{
+		// Venus
+		{1.3383167251, 4.303807402493E-7},		  // 76.6799 + 2.46590E-5 * d
+		{0.0592469467881995, 4.799655442984E-10}, // 3.3946 + 2.75E-8 * d
+		{0.958028679712207, 2.415081899155E-7},	  // 54.8910 + 1.38374E-5 * d
+		{0.723330, 0.0},						  // (AU)
+		{0.006773, -1.302E-9},
+		{0.837848798078382, 2.796244746150E-2}, // 48.0052 + 1.6021302244 * d
+	},
+	{
+		// Moon
+		{2.18380482931436, -9.242183063049E-4}, // 125.1228 - 0.0529538083 * d
+		{0.0898041713321162, 0.0},				// 5.1454
+		{5.55125356008773, 2.868576423897E-3},	// 318.0634 + 0.1643573223 * d
+		{60.2666, 0.0},							// (Earth radii)
+		{0.0549, 0.0},
+		{2.01350607288027, 2.280271437431E-1}, // 115.3654 + 13.0649929509 * d
+	},
+	{
+		// Mars
+		{0.864939798727838, 3.68405843840215E-7},	 // 49.5574 + 2.11081E-5 * d
+		{0.0322833551741391, -3.10668606854991E-10}, // 1.8497 - 1.78E-8 * d
+		{5.00039623223179, 5.11313402993511E-7},	 // 286.5016 + 2.92961E-5 * d
+		{1.523688, 0.0},							 // (AU)
+		{0.093405, 2.516E-9},
+		{0.324667892785237, 9.14588790052766E-3}, // 18.6021 + 0.5240207766 * d
+	},
+	{
+		// Jupiter
+		{1.75325653745689, 4.832013847316E-7},	  // 100.4542 + 2.76854E-5 * d
+		{0.0227416401534861, -2.717477645355E-9}, // 1.3030 - 1.557E-7 * d
+		{4.78006761278927, 2.871153885993E-7},	  // 273.8777 + 1.64505E-5 * d
+		{5.20256, 0.0},							  // (AU)
+		{0.048498, 4.469E-9},
+		{0.347233254684272, 1.450112046753E-3}, // 19.8950 + 0.0830853001 * d
+	},
+	{
+		// Saturn
+		{1.98380056901132, 4.170987846416E-7},	  // 113.6634 + 2.38980E-5 * d
+		{0.0434342637651309, -1.886700921406E-9}, // 2.4886 - 1.081E-7 * d
+		{5.92354101618438, 5.195164504779E-7},	  // 339.3939 + 2.97661E-5 * d
+		{9.55475, 0.0},							  // (AU)
+		{0.055546, -9.499E-9},
+		{5.53211777016887, 5.837118978783E-4}, // 316.9670 + 0.0334442282 * d
+	},
+	{
+		// Uranus
+		{1.29155237312206, 2.439621228438E-7},	  // 74.0005 + 1.3978E-5 * d
+		{0.0134966311056722, 3.316125578789E-10}, // 0.7733 + 1.9E-8 * d
+		{1.68705619892874, 5.334598858721E-7},	  // 96.6612 + 3.0565E-5 * d
+		{19.18171, -1.55E-8},					  // (AU)
+		{0.047318, 7.45E-9},
+		{2.48867370706497, 2.046539221501E-4}, // 142.5905 + 0.011725806 * d
+	},
+	{
+		// Neptune
+		{2.30000536025364, 5.266181952043E-7},	  // 131.7806 + 3.0173E-5 * d
+		{0.0308923277602996, -4.450589592586E-9}, // 1.7700 - 2.55E-7 * d
+		{4.7620627962257, -1.051909940177E-7},	  // 272.8461 - 6.027E-6 * d
+		{30.05826, 3.313E-8},					  // (AU)
+		{0.008606, 2.15E-9},
+		{4.54216876376693, 1.046350542911E-4}, // 260.2471 + 0.005995147 * d
+	},
+};
+
+/**
+ * Evaluate one orbital element of an object for a day
+ *
+ * @param [in] object 1 to 8
+ * @param [in] n element, 0 to 5 as in elements
+ * @param [in] d days since 31-12-1999T00:00:00
+ */
+static double getElement(int object, int n, double d)
+{
+	element e;
+
+	memcpy_P(&e, &elements[object - 1][n], sizeof(element));
+	return e.base + e.rate * d;
+}
+
+// what a perturbation term is added to, optionally or-ed with term_cos
+#define term_lon 0
+#define term_lat 1
+#define term_ro 2
+#define term_cos 4
+
+/**
+ * A perturbation term amplitude * sin(argument), or cos with term_cos. The
+ * argument is phase plus the sum of the multiples k of four angles, which
+ * are Mo, F, ddo and Ms for the moon and Mj, Ma and Mu for the planets.
+ */
+struct perturbation
+{
+	double amplitude;
+	double phase;
+	int8_t k[4];
+	uint8_t kind;
+};
+
+/**
+ * Perturbations of the moon, jupiter, saturn and uranus, in that order.
+ * The original degrees are in the comments.
+ * http://www.stjarnhimlen.se/comp/ppcomp.html#9
+ * http://www.stjarnhimlen.se/comp/ppcomp.html#10
+ */
+static const perturbation perturbations[] PROGMEM = {
+	// moon longitude
+	{-0.022235495, 0.0, {1, 0, -2, 0}, term_lon}, // -1.274 (the Evection)
+	{0.011484266, 0.0, {0, 0, 2, 0}, term_lon},	  //  0.658 (the Variation)
+	{-0.003246312, 0.0, {0, 0, 0, 1}, term_lon},  // -0.186 (the Yearly Equation)
+	{-0.001029744, 0.0, {2, 0, -2, 0}, term_lon}, // -0.059
+	{-0.000994838, 0.0, {1, 0, -2, 1}, term_lon}, // -0.057
+	{0.000925025, 0.0, {1, 0, 2, 0}, term_lon},	  //  0.053
+	{0.000802851, 0.0, {0, 0, 2, -1}, term_lon},  //  0.046
+	{0.000715585, 0.0, {1, 0, 0, -1}, term_lon},  //  0.041
+	{-0.000610865, 0.0, {0, 0, 1, 0}, term_lon},  // -0.035 (the Parallactic Equation)
+	{-0.000541052, 0.0, {1, 0, 0, 1}, term_lon},  // -0.031
+	{-0.000261799, 0.0, {0, 2, -2, 0}, term_lon}, // -0.015
+	{0.000191986, 0.0, {1, 0, -4, 0}, term_lon},  //  0.011
+	// moon latitude
+	{-0.003019420, 0.0, {0, 1, -2, 0}, term_lat},  // -0.173
+	{-0.000959931, 0.0, {1, -1, -2, 0}, term_lat}, // -0.055
+	{-0.000802851, 0.0, {1, 1, -2, 0}, term_lat},  // -0.046
+	{0.000575959, 0.0, {0, 1, 2, 0}, term_lat},	   //  0.033
+	{0.000296706, 0.0, {2, 1, 0, 0}, term_lat},	   //  0.017
+	// moon distance in earth radii
+	{-0.58, 0.0, {1, 0, -2, 0}, term_ro | term_cos},
+	{-0.46, 0.0, {0, 0, 2, 0}, term_ro | term_cos},
+	// jupiter
+	{-0.332, -1.17984257434817, {2, -5, 0, 0}, term_lon}, // 67.6
+	{-0.056, 0.366519142918809, {2, -2, 0, 0}, term_lon}, // 21
+	{0.042, 0.366519142918809, {3, -5, 0, 0}, term_lon},  // 21
+	{-0.036, 0.0, {1, -2, 0, 0}, term_lon},
+	{0.022, 0.0, {1, -1, 0, 0}, term_lon | term_cos},
+	{0.023, 0.907571211037051, {2, -3, 0, 0}, term_lon}, // 52
+	{-0.016, -1.20427718387609, {1, -5, 0, 0}, term_lon}, // 69
+	// saturn
+	{0.812, -1.17984257434817, {2, -5, 0, 0}, term_lon},				 // 67.6
+	{-0.229, -0.0349065850398866, {2, -4, 0, 0}, term_lon | term_cos}, // 2
+	{0.119, -0.0523598775598299, {1, -2, 0, 0}, term_lon},			 // 3
+	{0.046, -1.17984257434817, {2, -6, 0, 0}, term_lon},				 // 67.6
+	{0.014, 0.558505360638185, {1, -3, 0, 0}, term_lon},				 // 32
+	{-0.020, -0.0349065850398866, {2, -4, 0, 0}, term_lat | term_cos}, // 2
+	{0.018, -0.855211333477221, {2, -6, 0, 0}, term_lat},				 // 49
+	// uranus
+	{0.040, 0.10471975511966, {0, 1, -2, 0}, term_lon},	  // 6
+	{0.035, 0.575958653158129, {0, 1, -3, 0}, term_lon},  // 33
+	{-0.015, 0.349065850398866, {1, 0, -1, 0}, term_lon}, // 20
+};
+
+/**
+ * first entry in perturbations for objects 0 to 8, the last entry is the
+ * end of the table
+ */
+static const uint8_t perturbations_from[10] PROGMEM = {0, 0, 0, 0, 19, 19, 26, 33, 36, 36};
+
 /**
  * This function will compute the RA an DE of any of the solar systems objects
  * as seen from the earth. It needs only the time (supplied by now) and will
@@ -32,23 +218,26 @@
  *
  * All math kindly obtained from http://www.stjarnhimlen.se/comp/ppcomp.html
  *
- *  We do not calculate the topocentric position of the moon
- * (www.stjarnhimlen.se/comp/ppcomp.html#13). We also do not provide code for
+ * The topocentric position of the moon is not calculated here, but by
+ * topocentric() (www.stjarnhimlen.se/comp/ppcomp.html#13) using the distance
+ * returned here. We also do not provide code for
  * - pluto (www.stjarnhimlen.se/comp/ppcomp.html#14)
  * - the elongation and physical ephemerides of the planets
  *   (www.stjarnhimlen.se/comp/ppcomp.html#15)
- * - asteroids (www.stjarnhimlen.se/comp/ppcomp.html#16)
- * - comets (www.stjarnhimlen.se/comp/ppcomp.html#17 and
- *   www.stjarnhimlen.se/comp/ppcomp.html#18 and
- *   www.stjarnhimlen.se/comp/ppcomp.html#19)
  * - planet moons.
+ *
+ * Comets and asteroids (www.stjarnhimlen.se/comp/ppcomp.html#16 to #19) are
+ * objects from first_minor on, with their elements in EEPROM, when
+ * MINOR_BODIES is defined. Their heliocentric position is computed in
+ * orbit.cpp, from there on the path is the same as for the planets.
  * 
  * @param [in] object index of sun/planet/moon, 0 indexed
  * @param [in] now current time in UTC
  * @param [out] object_ra Right Ascention in hours
  * @param [out] object_dc Declination in degrees
+ * @param [out] moon_ro distance in earth radii, only set for the moon
  */
-void getPlanet(int object, time_t now, double *object_ra, double *object_dc)
+void getPlanet(int object, time_t now, double *object_ra, double *object_dc, double *moon_ro)
 {
 	double d; // days to Dec 31st 0h00 1999 - note, this is NOT same as J2000
 
@@ -59,14 +248,9 @@ void getPlanet(int object, time_t now, double *object_ra, double *object_dc)
 	double wo;	// Argument of perihelion for the object
 	double ws;	// Argument of perihelion for the Sun
 	double ao;	// Object semi-major axis, or mean distance from Earth (AU, Earth radii for the Moon)
-	double as;	// Sun (earth) semi-major axis, or mean distance from Sun (AU)
 	double eco; // Object eccentricity (0=circle, 0-1=ellipse, 1=parabola)
-	double ecs; // Sun (earth) eccentricity (0=circle, 0-1=ellipse, 1=parabola)
 	double Mo;	// Mean Anomaly of the object
 	double Ms;	// Mean Anomaly of the Sun (earth)
-	double Mj;	// Mean anomaly of Jupiter
-	double Ma;	// Mean anomaly of sAturn
-	double Mu;	// Mean anomaly of Uranus
 
 	double lat;		// Object geocentric lat
 	double lon;		// Object geocentric long
@@ -75,6 +259,7 @@ void getPlanet(int object, time_t now, double *object_ra, double *object_dc)
 	double EoDelta; // Temp for iteration
 	double xv, yv;	// Temp vector to compute distance and true anomaly
 	double lonsun;	// Sun's true longitude
+	double rs;		// Sun's distance
 
 	double ddo; // Mean elongation of the object
 	double F;	// Argument of latitude for the object
@@ -85,234 +270,148 @@ void getPlanet(int object, time_t now, double *object_ra, double *object_dc)
 
 	double xh, yh, zh; // vector position of object seen from the sun
 	double xg, yg, zg; // h-vector + Sun (=earth) position
-	double xe, ye, ze; // g-vector converted after ecliptic rotation
-
-	double ecl; // obliquity of the ecliptic, i.e. the "tilt" of the Earth's axis of rotation
 
 	// http://www.stjarnhimlen.se/comp/ppcomp.html#3
 
 	d = (now - 946684800.0) / 86400.0 + 1; // days since 31-12-1999T00:00:00
 
-	// sun elements
-	// http://www.stjarnhimlen.se/comp/ppcomp.html#4
-
-	// Ns = 0.0;                                         // 0.0
-	// is = 0.0;                                         // 0.0
-	ws = 4.93824156690976 + 8.219366312880E-7 * d; // 282.9404 + 4.70935E-05 * d
-	as = 1.0;									   // (AU)
-	ecs = 0.016709 - 1.151E-09 * d;
-	Ms = 6.21419244184825 + 1.720196961933E-2 * d; // 356.047 + 0.9856002585 * d
-
-	// http://www.stjarnhimlen.se/comp/ppcomp.html#5
-
-	Eo = Ms + ecs * sin(Ms) * (1.0 + ecs * cos(Ms));
-	xv = as * (cos(Eo) - ecs);
-	yv = as * (sqrt(1.0 - ecs * ecs) * sin(Eo));
-	vo = atan2(yv, xv);
-	ro = sqrt(xv * xv + yv * yv);
-
-	lonsun = vo + ws;	   // lonsun is used for planetary positions
-	xg = ro * cos(lonsun); // xg, yg and zg are converted to RA and DE
-	yg = ro * sin(lonsun);
+	// sun, lonsun is also used for planetary positions
+	orbitSun(d, &Ms, &ws, &lonsun, &rs);
+	xg = rs * trig_cos(lonsun); // xg, yg and zg are converted to RA and DE
+	yg = rs * trig_sin(lonsun);
 	zg = 0;
 
 	// Sun's equatorial coordinates, RA and Dec are computed and the end of this fuunction
 	// if not the sun, get the object elements
-	// http://www.stjarnhimlen.se/comp/ppcomp.html#4
-
-	switch (object)
+	if (object >= 1 && object <= 8)
 	{
-	case 1:												 // Orbital elements of Mercury
-		No = 0.843540316769135 + 5.665111859171E-7 * d;	 // 48.3313 + 3.24587E-5 * d;
-		io = 0.122255078114447 + 8.726646259972E-10 * d; //  7.0047 + 5.00E-8 * d;
-		wo = 0.508311436680081 + 1.770531806393E-7 * d;	 // 29.1241 + 1.01444E-5 * d;
-		ao = 0.387098;									 // (AU)
-		eco = 0.205635 + 5.59E-10 * d;
-		Mo = 2.94360599390206 + 7.142471001491E-2 * d; // 168.6562 + 4.0923344368 * d;
-		break;
-
-	case 2:												  // Orbital elements of Venus
-		No = 1.3383167251 + 4.303807402493E-7 * d;		  // 76.6799 + 2.46590E-5 * d;
-		io = 0.0592469467881995 + 4.799655442984E-10 * d; // 3.3946 + 2.75E-8 * d;
-		wo = 0.958028679712207 + 2.415081899155E-7 * d;	  // 54.8910 + 1.38374E-5 * d;
-		ao = 0.723330;									  // (AU)
-		eco = 0.006773 - 1.302E-9 * d;
-		Mo = 0.837848798078382 + 2.796244746150E-2 * d; // 48.0052 + 1.6021302244 * d;
-		break;
-
-	case 3:											   // Orbital elements of the Moon
-		No = 2.18380482931436 - 9.242183063049E-4 * d; // 125.1228 - 0.0529538083# * d
-		io = 0.0898041713321162;					   // 5.1454
-		wo = 5.55125356008773 + 2.868576423897E-3 * d; // 318.0634 + 0.1643573223# * d
-		ao = 60.2666;								   // (Earth radii)
-		eco = 0.0549;
-		Mo = 2.01350607288027 + 2.280271437431E-1 * d; // 115.3654 + 13.0649929509 * d
-		break;
-
-	case 4:													// Orbital elements of Mars
-		No = 0.864939798727838 + 3.68405843840215E-7 * d;	// 49.5574 + 2.11081E-5 * d;
-		io = 0.0322833551741391 - 3.10668606854991E-10 * d; // 1.8497 - 1.78E-8 * d;
-		wo = 5.00039623223179 + 5.11313402993511E-7 * d;	// 286.5016 + 2.92961E-5 * d;
-		ao = 1.523688;										// (AU)
-		eco = 0.093405 + 2.516E-9 * d;
-		Mo = 0.324667892785237 + 9.14588790052766E-3 * d; // 18.6021 + 0.5240207766 * d;
-		break;
-
-	case 5:												 // Orbital elements of Jupiter
-		No = 1.75325653745689 + 4.832013847316E-7 * d;	 // 100.4542 + 2.76854E-5 * d;
-		io = 0.0227416401534861 - 2.717477645355E-9 * d; // 1.3030 - 1.557E-7 * d;
-		wo = 4.78006761278927 + 2.871153885993E-7 * d;	 // 273.8777 + 1.64505E-5 * d;
-		ao = 5.20256;									 // (AU)
-		eco = 0.048498 + 4.469E-9 * d;
-		Mo = 0.347233254684272 + 1.450112046753E-3 * d; // 19.8950 + 0.0830853001 * d;
-		break;
-
-	case 6:												 // Orbital elements of Saturn
-		No = 1.98380056901132 + 4.170987846416E-7 * d;	 // 113.6634 + 2.38980E-5 * d;
-		io = 0.0434342637651309 - 1.886700921406E-9 * d; // 2.4886 - 1.081E-7 * d;
-		wo = 5.92354101618438 + 5.195164504779E-7 * d;	 // 339.3939 + 2.97661E-5 * d;
-		ao = 9.55475;									 // (AU)
-		eco = 0.055546 - 9.499E-9 * d;
-		Mo = 5.53211777016887 + 5.837118978783E-4 * d; // 316.9670 + 0.0334442282 * d;
-		break;
-
-	case 7:												  // Orbital elements of Uranus
-		No = 1.29155237312206 + 2.439621228438E-7 * d;	  // 74.0005 + 1.3978E-5 * d;
-		io = 0.0134966311056722 + 3.316125578789E-10 * d; // 0.7733 + 1.9E-8 * d;
-		wo = 1.68705619892874 + 5.334598858721E-7 * d;	  // 96.6612 + 3.0565E-5 * d;
-		ao = 19.18171 - 1.55E-8 * d;					  // (AU)
-		eco = 0.047318 + 7.45E-9 * d;
-		Mo = 2.48867370706497 + 2.046539221501E-4 * d; // 142.5905 + 0.011725806 * d;
-		break;
-
-	case 8:												 // Orbital elements of Neptune
-		No = 2.30000536025364 + 5.266181952043E-7 * d;	 // 131.7806 + 3.0173E-5 * d;
-		io = 0.0308923277602996 - 4.450589592586E-9 * d; // 1.7700 - 2.55E-7 * d;
-		wo = 4.7620627962257 - 1.051909940177E-7 * d;	 // 272.8461 - 6.027E-6 * d;
-		ao = 30.05826 + 3.313E-8 * d;					 // (AU)
-		eco = 0.008606 + 2.15E-9 * d;
-		Mo = 4.54216876376693 + 1.046350542911E-4 * d; // 260.2471 + 0.005995147 * d;
-		break;
+		No = getElement(object, 0, d);
+		io = getElement(object, 1, d);
+		wo = getElement(object, 2, d);
+		ao = getElement(object, 3, d);
+		eco = getElement(object, 4, d);
+		Mo = getElement(object, 5, d);
 	}
 
 	if (object != 0)
 	{ // for all objects, except the sun
 
-		// eccentric anomaly of the object
-		// http://www.stjarnhimlen.se/comp/ppcomp.html#6
+#ifdef MINOR_BODIES
+		if (object >= first_minor)
+		{ // comet or asteroid, with the precession to date included
+			orbit_elements el;
 
-		Eo = Mo + eco * sin(Mo) * (1.0 + eco * cos(Mo));
-		EoDelta = 1.0;
-		while (EoDelta < -0.000872664 || EoDelta > 0.000872664)
+			minorElements(object - first_minor, &el);
+			orbitHeliocentric(&el, d, &xh, &yh, &zh);
+			ro = sqrt(xh * xh + yh * yh + zh * zh);
+		}
+		else
+#endif
 		{
-			Eo1 = Eo - (Eo - eco * sin(Eo) - Mo) / (1 - eco * cos(Eo));
-			EoDelta = Eo - Eo1;
-			Eo = Eo1;
+			// eccentric anomaly of the object
+			// http://www.stjarnhimlen.se/comp/ppcomp.html#6
+
+			Eo = Mo + eco * trig_sin(Mo) * (1.0 + eco * trig_cos(Mo));
+			EoDelta = 1.0;
+			while (EoDelta < -0.000872664 || EoDelta > 0.000872664)
+			{
+				Eo1 = Eo - (Eo - eco * trig_sin(Eo) - Mo) / (1 - eco * trig_cos(Eo));
+				EoDelta = Eo - Eo1;
+				Eo = Eo1;
+			}
+
+			// objects vector
+			xv = ao * (trig_cos(Eo) - eco);
+			yv = ao * (sqrt(1.0 - eco * eco) * trig_sin(Eo));
+
+			// object true anomaly an distance
+			vo = trig_atan2(yv, xv);
+			ro = sqrt(xv * xv + yv * yv);
+
+			// object geocentric position in 3D space
+			// http://www.stjarnhimlen.se/comp/ppcomp.html#7
+
+			xh = ro * (trig_cos(No) * trig_cos(vo + wo) - trig_sin(No) * trig_sin(vo + wo) * trig_cos(io));
+			yh = ro * (trig_sin(No) * trig_cos(vo + wo) + trig_cos(No) * trig_sin(vo + wo) * trig_cos(io));
+			zh = ro * (trig_sin(vo + wo) * trig_sin(io));
 		}
 
-		// objects vector
-		xv = ao * (cos(Eo) - eco);
-		yv = ao * (sqrt(1.0 - eco * eco) * sin(Eo));
-
-		// object true anomaly an distance
-		vo = atan2(yv, xv);
-		ro = sqrt(xv * xv + yv * yv);
-
-		// object geocentric position in 3D space
-		// http://www.stjarnhimlen.se/comp/ppcomp.html#7
-
-		xh = ro * (cos(No) * cos(vo + wo) - sin(No) * sin(vo + wo) * cos(io));
-		yh = ro * (sin(No) * cos(vo + wo) + cos(No) * sin(vo + wo) * cos(io));
-		zh = ro * (sin(vo + wo) * sin(io));
-
 		// objects geocentric long and lat
-		lon = atan2(yh, xh);
-		lat = atan2(zh, sqrt(xh * xh + yh * yh));
+		lon = trig_atan2(yh, xh);
+		lat = trig_atan2(zh, sqrt(xh * xh + yh * yh));
 
-		// No precession corrections
+		// The planets' elements are of date, the comets and asteroids are
+		// turned to the equinox of date by orbitHeliocentric()
 		// http://www.stjarnhimlen.se/comp/ppcomp.html#8
 		// Pertubations for the moon, jupiter, saturn and uranus
 
-		if (object == 3)
-		{ // moon
+		uint8_t from = 0;
+		uint8_t to = 0;
+		double args[4]; // angles the perturbation arguments are made of
 
-			// http://www.stjarnhimlen.se/comp/ppcomp.html#9
+		if (object <= 8)
+		{
+			from = pgm_read_byte(&perturbations_from[object]);
+			to = pgm_read_byte(&perturbations_from[object + 1]);
+		}
 
-			// first calculate arguments below, which should be in radians
+		if (object == 3)
+		{ // moon, http://www.stjarnhimlen.se/comp/ppcomp.html#9
 			Ls = Ms + ws;	   // Mean Longitude of the Sun  (Ns=0)
 			Lo = Mo + wo + No; // Mean longitude of the Moon
 			ddo = Lo - Ls;	   // Mean elongation of the Moon
 			F = Lo - No;	   // Argument of latitude for the Moon
-
-			// then add the following terms to the longitude
-			lon = lon - 0.022235495 * sin(Mo - 2 * ddo);	  // -1.274 (the Evection)
-			lon = lon + 0.011484266 * sin(2 * ddo);			  //  0.658 (the Variation)
-			lon = lon - 0.003246312 * sin(Ms);				  // -0.186 (the Yearly Equation)
-			lon = lon - 0.001029744 * sin(2 * Mo - 2 * ddo);  // -0.059
-			lon = lon - 0.000994838 * sin(Mo - 2 * ddo + Ms); // -0.057
-			lon = lon + 0.000925025 * sin(Mo + 2 * ddo);	  //  0.053
-			lon = lon + 0.000802851 * sin(2 * ddo - Ms);	  //  0.046
-			lon = lon + 0.000715585 * sin(Mo - Ms);			  //  0.041
-			lon = lon - 0.000610865 * sin(ddo);				  // -0.035 (the Parallactic Equation)
-			lon = lon - 0.000541052 * sin(Mo + Ms);			  // -0.031
-			lon = lon - 0.000261799 * sin(2 * F - 2 * ddo);	  // -0.015
-			lon = lon + 0.000191986 * sin(Mo - 4 * ddo);	  //  0.011
-
-			// latitude terms
-			lat = lat - 0.003019420 * sin(F - 2 * ddo);		 // -0.173
-			lat = lat - 0.000959931 * sin(Mo - F - 2 * ddo); // -0.055
-			lat = lat - 0.000802851 * sin(Mo + F - 2 * ddo); // -0.046
-			lat = lat + 0.000575959 * sin(F + 2 * ddo);		 //  0.033
-			lat = lat + 0.000296706 * sin(2 * Mo + F);		 //  0.017
-
-			// distance terms earth radii
-			ro = ro - 0.58 * cos(Mo - 2 * ddo);
-			ro = ro - 0.46 * cos(2 * ddo);
+			args[0] = Mo;
+			args[1] = F;
+			args[2] = ddo;
+			args[3] = Ms;
+		}
+		else if (from != to)
+		{ // jupiter, saturn and uranus, http://www.stjarnhimlen.se/comp/ppcomp.html#10
+			args[0] = getElement(5, 5, d); // Mj
+			args[1] = getElement(6, 5, d); // Ma
+			args[2] = getElement(7, 5, d); // Mu
+			args[3] = 0.0;
 		}
 
-		// http://www.stjarnhimlen.se/comp/ppcomp.html#10
-		// jupiter || saturn || uranus)
-		if (object == 5 || object == 6 || object == 7)
+		for (uint8_t n = from; n < to; n++)
 		{
-			Mj = 0.347233254684272 + 1.450112046753E-3 * d; // 19.8950 + 0.0830853001 * d
-			Ma = 5.53211777016887 + 5.837118978783E-4 * d;	// 316.9670 + 0.0334442282 * d
-			Mu = 2.48867370706497 + 2.046539221501E-4 * d;	// 142.5905 + 0.011725806  * d; //deg
-		}
-		if (object == 5)
-		{																  // jupiter
-			lon = lon - 0.332 * sin(2 * Mj - 5 * Ma - 1.17984257434817);  // 67.6
-			lon = lon - 0.056 * sin(2 * Mj - 2 * Ma + 0.366519142918809); // 21
-			lon = lon + 0.042 * sin(3 * Mj - 5 * Ma + 0.366519142918809); // 21
-			lon = lon - 0.036 * sin(Mj - 2 * Ma);
-			lon = lon + 0.022 * cos(Mj - Ma);
-			lon = lon + 0.023 * sin(2 * Mj - 3 * Ma + 0.907571211037051); // 52
-			lon = lon - 0.016 * sin(Mj - 5 * Ma - 1.20427718387609);	  // 69
-		}
-		else if (object == 6)
-		{																   // saturn
-			lon = lon + 0.812 * sin(2 * Mj - 5 * Ma - 1.17984257434817);   // 67.6
-			lon = lon - 0.229 * cos(2 * Mj - 4 * Ma - 0.0349065850398866); // 2
-			lon = lon + 0.119 * sin(Mj - 2 * Ma - 0.0523598775598299);	   // 3
-			lon = lon + 0.046 * sin(2 * Mj - 6 * Ma - 1.17984257434817);   // 67.6
-			lon = lon + 0.014 * sin(Mj - 3 * Ma + 0.558505360638185);	   // 32
-			lat = lat - 0.020 * cos(2 * Mj - 4 * Ma - 0.0349065850398866); // 2
-			lat = lat + 0.018 * sin(2 * Mj - 6 * Ma - 0.855211333477221);  // 49
-		}
-		else if (object == 7)
-		{															  // uranus
-			lon = lon + 0.040 * sin(Ma - 2 * Mu + 0.10471975511966);  // 6
-			lon = lon + 0.035 * sin(Ma - 3 * Mu + 0.575958653158129); // 33
-			lon = lon - 0.015 * sin(Mj - Mu + 0.349065850398866);	  // 20
+			perturbation p;
+			double arg = 0.0;
+			double term;
+
+			memcpy_P(&p, &perturbations[n], sizeof(perturbation));
+			for (uint8_t m = 0; m < 4; m++)
+				if (p.k[m])
+					arg += p.k[m] * args[m];
+			arg += p.phase;
+			term = p.amplitude * ((p.kind & term_cos) ? trig_cos(arg) : trig_sin(arg));
+
+			switch (p.kind & ~term_cos)
+			{
+			case term_lon:
+				lon = lon + term;
+				break;
+			case term_lat:
+				lat = lat + term;
+				break;
+			case term_ro:
+				ro = ro + term;
+				break;
+			}
 		}
 
+		if (object == 3)
+			*moon_ro = ro; // used by topocentric()
+
 		// recalculate planets position in 3D space after pertubations
 		// and compute Geocentric (Earth-centered) coordinates
 
 		// http://www.stjarnhimlen.se/comp/ppcomp.html#11
 
-		xh = ro * cos(lon) * cos(lat);
-		yh = ro * sin(lon) * cos(lat);
-		zh = ro * sin(lat);
+		xh = ro * trig_cos(lon) * trig_cos(lat);
+		yh = ro * trig_sin(lon) * trig_cos(lat);
+		zh = ro * trig_sin(lat);
 
 		if (object == 3)
 		{ // moon is viewed directly from the earth
@@ -322,26 +421,14 @@ void getPlanet(int object, time_t now, double *object_ra, double *object_dc)
 		}
 		else
 		{ // add the sun's (=earth) position
-			xg = xh + as * cos(lonsun);
-			yg = yh + as * sin(lonsun);
+			xg = xh + rs * trig_cos(lonsun);
+			yg = yh + rs * trig_sin(lonsun);
 			zg = zh;
 		}
 	}
 
 	// rotate to equatorial coords
-	// http://www.stjarnhimlen.se/comp/ppcomp.html#12
-
-	// obliquity of ecliptic of date
-	ecl = 0.409092959362707 + 6.218608124856E-9 * d; // 23.4393 - 0.0000003563 * d;
-	xe = xg;
-	ye = yg * cos(ecl) - zg * sin(ecl);
-	ze = yg * sin(ecl) + zg * cos(ecl);
-
-	// geocentric RA and Dec
-	*object_ra = atan2(ye, xe) * 12.0 / pi;
-	if (*object_ra < 0.0)
-		*object_ra += 24.0;
-	*object_dc = atan(ze / sqrt(xe * xe + ye * ye)) * 180 / pi;
+	orbitEquatorial(d, xg, yg, zg, object_ra, object_dc);
 
 #ifdef SERIAL_DEBUG
 	Serial.println("* object *************");
@@ -353,12 +440,6 @@ void getPlanet(int object, time_t now, double *object_ra, double *object_dc)
 	Serial.println(Ms);
 	Serial.print("Mo ");
 	Serial.println(Mo);
-	Serial.print("Eo ");
-	Serial.println(Eo);
-	Serial.print("xv ");
-	Serial.println(xv);
-	Serial.print("yv ");
-	Serial.println(yv);
 	Serial.print("xh ");
 	Serial.println(xh);
 	Serial.print("yh ");
@@ -374,14 +455,8 @@ void getPlanet(int object, time_t now, double *object_ra, double *object_dc)
 
 /**
  * Set the Right Ascention in decimal hours and the Declination in degrees of
- * the choosen object. 0=sun etc. If adding to the list, update max_object in
- * astronomy.h
- * 
- * Use https://www.astrouw.edu.pl/~jskowron/ra-dec/?q=03%3A47%3A29.1+24%3A6%3A18
- * as a converter and double check with it's link to wikisky.org
- * 
- * Even better, use http://server1.sky-map.org/search?star=alcyone to
- * directly find coordinates.
+ * the choosen object. 0=sun etc. Stars are taken from the catalog in
+ * skygrid.cpp.
  *
  * Note that the "user interface" (using beeps) uses base 1 so i.e. one beep
  * is the Sun
@@ -389,39 +464,74 @@ void getPlanet(int object, time_t now, double *object_ra, double *object_dc)
  * @param [in] now current time in UTC
  * @param [out] object_ra Right Ascention in hours
  * @param [out] object_dc Declination in degrees
+ * @param [out] object_ro distance in earth radii of the moon and the
+ * satellite, for topocentric(), 0 for other objects
  */
-void getObject(int index, time_t now, double *object_ra, double *object_dc)
+void getObject(int index, time_t now, double *object_ra, double *object_dc, double *object_ro)
 {
-	switch (index)
-	{
-	case 9: // Arcturis
-		*object_ra = 14.261;
-		*object_dc = 19.182;
-		break;
-	case 10: // Vega
-		*object_ra = 18.616;
-		*object_dc = 38.784;
-		break;
-	case 11: // Dubhe (rotates within the northern half of the azimuthal grid)
-		*object_ra = 11.062;
-		*object_dc = 61.751;
-		break;
-	case 12: // Capella (rotates within the northern half of the azimuthal grid)
-		*object_ra = 5.278;
-		*object_dc = 45.998;
-		break;
-	case 13: // Castor
-		*object_ra = 7.577;
-		*object_dc = 31.888;
-		break;
-	case 14: // Alcyone
-		*object_ra = 3.7914;
-		*object_dc = 24.105;
-		break;
-	default:
-		getPlanet(index, now, object_ra, object_dc);
-		break;
-	}
+	*object_ro = 0.0;
+#ifdef MINOR_BODIES
+	if (index >= first_minor)
+		getPlanet(index, now, object_ra, object_dc, object_ro);
+	else
+#endif
+#ifdef SATELLITE
+	if (index == object_satellite)
+		getSatellite(now, object_ra, object_dc, object_ro);
+	else
+#endif
+	if (index >= first_star)
+		getStar(index, object_ra, object_dc);
+	else
+		getPlanet(index, now, object_ra, object_dc, object_ro);
+}
+
+/**
+ * http://www.stjarnhimlen.se/comp/ppcomp.html#13
+ *
+ * Correct the geocentric RA and DC of the moon for parallax, which is up to
+ * about 1 degree, and of the satellite, for which it is anything up to 90
+ * degrees. Other objects are too far away to bother and are left as they
+ * are. Instead of the small angle approximation, the observer's position is
+ * subtracted from the object's position vector, with the geocentric latitude
+ * and distance of the observer as given in the link above.
+ *
+ * @param [in] index number of the object, only 3 (moon) and the satellite
+ * are corrected
+ * @param [in] object_ro distance in earth radii, as given by getObject()
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] sidereal_r Sidereal time units: rads
+ * @param [in,out] object_ra Right Ascention in hours
+ * @param [in,out] object_dc Declination in degrees
+ */
+void topocentric(int index, double object_ro, double loc_lat_d, double sidereal_r,
+				 double *object_ra, double *object_dc)
+{
+#ifdef SATELLITE
+	if (index != 3 && index != object_satellite)
+		return;
+#else
+	if (index != 3)
+		return;
+#endif
+
+	double loc_lat_r = loc_lat_d / 180.0 * pi;
+	double ra_r = *object_ra / 12.0 * pi;
+	double dc_r = *object_dc / 180.0 * pi;
+
+	// geocentric latitude and distance of the observer in earth radii
+	double gclat = loc_lat_r - 0.003358022 * trig_sin(2 * loc_lat_r); // 0.1924 deg
+	double rho = 0.99833 + 0.00167 * trig_cos(2 * loc_lat_r);
+
+	// object minus observer, both in earth radii
+	double x = object_ro * trig_cos(dc_r) * trig_cos(ra_r) - rho * trig_cos(gclat) * trig_cos(sidereal_r);
+	double y = object_ro * trig_cos(dc_r) * trig_sin(ra_r) - rho * trig_cos(gclat) * trig_sin(sidereal_r);
+	double z = object_ro * trig_sin(dc_r) - rho * trig_sin(gclat);
+
+	*object_ra = trig_atan2(y, x) * 12.0 / pi;
+	if (*object_ra < 0.0)
+		*object_ra += 24.0;
+	*object_dc = trig_atan2(z, sqrt(x * x + y * y)) * 180.0 / pi;
 }
 
 /**
@@ -468,9 +578,9 @@ void transform(double object_ra_h, double object_dc_d,
 
 	// ecliptic xyz coorinates in vector coordinates length 1
 	// (1,0,0) is ha=0, dc=0
-	double object_ec_x = cos(hour_angle_r) * cos(object_dc_r);
-	double object_ec_y = sin(hour_angle_r) * cos(object_dc_r);
-	double object_ec_z = sin(object_dc_r);
+	double object_ec_x = trig_cos(hour_angle_r) * trig_cos(object_dc_r);
+	double object_ec_y = trig_sin(hour_angle_r) * trig_cos(object_dc_r);
+	double object_ec_z = trig_sin(object_dc_r);
 
 #ifdef SERIAL_DEBUG
 	Serial.println("* xyz ecliptic *********");
@@ -482,8 +592,8 @@ void transform(double object_ra_h, double object_dc_d,
 	// * rotate over the latitude **********************************************
 
 	// sin and cos of the latitude of the observer
-	double csin = sin(loc_lat_r);
-	double ccos = cos(loc_lat_r);
+	double csin = trig_sin(loc_lat_r);
+	double ccos = trig_cos(loc_lat_r);
 
 #ifdef SERIAL_DEBUG
 	Serial.println("* sin cos latitude *****");
@@ -506,8 +616,8 @@ void transform(double object_ra_h, double object_dc_d,
 	// * convert vector to angles **********************************************
 
 	// vector to rads, mirror the x axis
-	double object_az_r = atan2(tmp_y, tmp_x) + pi;
-	double object_al_r = atan2(tmp_z, sqrt(tmp_x * tmp_x + tmp_y * tmp_y));
+	double object_az_r = trig_atan2(tmp_y, tmp_x) + pi;
+	double object_al_r = trig_atan2(tmp_z, sqrt(tmp_x * tmp_x + tmp_y * tmp_y));
 
 #ifdef SERIAL_DEBUG
 	Serial.println("* az alt in deg ******");
@@ -521,25 +631,135 @@ void transform(double object_ra_h, double object_dc_d,
 }
 
 /**
- * Calculate siderial angle based in time an longitude
- * While not computed as documented in the following link, the result is the same
+ * Seconds for which the geocentric RA and DC of the objects stay within
+ * cache_error, from their largest apparent motion in degrees per day
+ */
+static const uint32_t cache_windows[9] PROGMEM = {
+	cache_window(1.02),	 // sun
+	cache_window(2.2),	 // mercury
+	cache_window(1.27),	 // venus
+	cache_window(16.5),	 // moon
+	cache_window(0.8),	 // mars
+	cache_window(0.24),	 // jupiter
+	cache_window(0.13),	 // saturn
+	cache_window(0.07),	 // uranus
+	cache_window(0.04)}; // neptune
+
+/**
+ * the last geocentric position computed by getHorizontal()
+ */
+static int cache_index = -1;
+static time_t cache_t;
+static double cache_ra;
+static double cache_dc;
+static double cache_ro;
+
+/**
+ * How long the cached position of an object may be used
  *
- * http://www.stjarnhimlen.se/comp/ppcomp.html#5b
+ * @param [in] index number of the object
+ * @returns seconds
+ */
+static uint32_t cacheWindow(int index)
+{
+#ifdef SATELLITE
+	if (index == object_satellite)
+		return 0; // moves degrees per second
+#endif
+#ifdef MINOR_BODIES
+	if (index >= first_minor)
+		return cache_window(10.0); // a comet passing close by
+#endif
+	if (index >= first_star)
+		return cache_window_stars;
+	return pgm_read_dword(&cache_windows[index]);
+}
+
+/**
+ * The full chain from object index to Azimuth and Altitude, as used to set
+ * the pointer: object position, optional apparent place corrections, moon
+ * parallax, transformation and optional refraction
  *
- * @param [in] t a 32 bit value in solar seconds since midnight 01-01-1970.
- * @param [in] loc_lng_d the longitude of the observer in degrees
- * @returns sidereal time in rads
+ * The position up to the apparent place corrections is kept and used again
+ * for the same object as long as it moves less than cache_error. Only the
+ * parallax, the transformation and the refraction, which depend on the
+ * sidereal time, are then computed. Going back in time always recomputes.
+ * Searches ahead in time (rise and set, the trajectory) do not use the
+ * cache, they would only replace the position of the pointer with one of
+ * their own times and take up to cache_error of error.
+ *
+ * @param [in] index number of the object
+ * @param [in] now current time in UTC
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] sidereal_r Sidereal time units: rads
+ * @param [out] object_az_d Azimuth units: degrees (0 - 359)
+ * @param [out] object_al_d Altitude units: degrees (-180 - 179)
+ * @param [in] cached use and keep the cached position
+ */
+void getHorizontal(int index, time_t now, double loc_lat_d, double sidereal_r,
+				   double *object_az_d, double *object_al_d, bool cached)
+{
+	double object_ra; // object RA in hours
+	double object_dc; // object DC in degrees
+	double object_ro; // object distance in earth radii
 
-*/
-double getSiderealAngle(time_t t, double loc_lng_d)
+	if (!cached)
+	{
+		getObject(index, now, &object_ra, &object_dc, &object_ro);
+		apparentPlace(index, now, &object_ra, &object_dc);
+	}
+	else if (index == cache_index && now >= cache_t && now - cache_t < cacheWindow(index))
+	{
+		object_ra = cache_ra;
+		object_dc = cache_dc;
+		object_ro = cache_ro;
+	}
+	else
+	{
+		getObject(index, now, &object_ra, &object_dc, &object_ro);
+		apparentPlace(index, now, &object_ra, &object_dc);
+		cache_index = index;
+		cache_t = now;
+		cache_ra = object_ra;
+		cache_dc = object_dc;
+		cache_ro = object_ro;
+	}
+	topocentric(index, object_ro, loc_lat_d, sidereal_r, &object_ra, &object_dc);
+	transform(object_ra, object_dc, loc_lat_d, sidereal_r, object_az_d, object_al_d);
+	*object_al_d = apparentAltitude(*object_al_d);
+}
+
+/**
+ * Forget the cached position, e.g. when the elements of an object change
+ */
+void clearHorizontalCache()
+{
+	cache_index = -1;
+}
+
+/**
+ * sidereal clock state, see getSiderealClock()
+ */
+static time_t sidereal_t = 0;	 // time of the last update, 0 if not seeded
+static double sidereal_lng = 0.0; // longitude the clock was seeded for
+static uint32_t sidereal_ms;	 // ms in the sidereal day at sidereal_t
 
+/**
+ * Calculate the ms in the local sidereal day
+ *
+ * @param [in] t a 32 bit value in solar seconds since midnight 01-01-1970.
+ * @param [in] loc_lng_d the longitude of the observer in degrees
+ * @returns ms in the sidereal day
+ */
+static uint32_t getSiderealMs(time_t t, double loc_lng_d)
 {
 	uint64_t ms; // time in ms
 	int32_t ln;	 // lonitude correction in ms
-	double sidereal_r;
 
-	ms = t * 1000ull;		  // t in ms units and 64 bits
-	ms -= siderial_ms_offset; // Greenwich Sidereal
+	// t in ms units and 64 bits, to Greenwich Sidereal. The offset is taken
+	// modulo the sidereal day, so times before it do not wrap around
+	ms = t * 1000ull;
+	ms += solar_ms_seconds_per_sidereal_day - siderial_ms_offset % solar_ms_seconds_per_sidereal_day;
 
 	ln = loc_lng_d * solar_ms_seconds_per_sidereal_day / 360.0;
 	ms += ln; // longitude correction to Local Sidereal
@@ -547,9 +767,79 @@ double getSiderealAngle(time_t t, double loc_lng_d)
 	// Calculation introduces 1 ms cummulative drift per day, so 0.36 seconds
 	// per year. As one step corresponds to roughly 40 seconds, drift by this
 	// calculation is totally neglectable over the course of several decades
-	ms = ms % solar_ms_seconds_per_sidereal_day; // ms in the sideral day
+	return ms % solar_ms_seconds_per_sidereal_day; // ms in the sideral day
+}
+
+/**
+ * Convert ms in the sidereal day to an angle
+ * @param [in] ms in the sidereal day
+ * @returns sidereal time in rads
+ */
+static double getSiderealRads(uint32_t ms)
+{
+	double sidereal_r;
 
 	sidereal_r = ms; // convert ms to angle
 	sidereal_r = sidereal_r * 2.0 * pi / solar_ms_seconds_per_sidereal_day;
 	return (sidereal_r);
 }
+
+/**
+ * Calculate siderial angle based in time an longitude
+ * While not computed as documented in the following link, the result is the same
+ *
+ * http://www.stjarnhimlen.se/comp/ppcomp.html#5b
+ *
+ * @param [in] t a 32 bit value in solar seconds since midnight 01-01-1970.
+ * @param [in] loc_lng_d the longitude of the observer in degrees
+ * @returns sidereal time in rads
+
+*/
+double getSiderealAngle(time_t t, double loc_lng_d)
+{
+	return getSiderealRads(getSiderealMs(t, loc_lng_d));
+}
+
+/**
+ * Seed the sidereal clock. This takes the full 64 bit calculation of
+ * getSiderealAngle(), so it is only done once, when the time jumps back or
+ * when the clock was not updated for more than sidereal_max_advance seconds.
+ *
+ * @param [in] t a 32 bit value in solar seconds since midnight 01-01-1970.
+ * @param [in] loc_lng_d the longitude of the observer in degrees
+ */
+void syncSiderealClock(time_t t, double loc_lng_d)
+{
+	sidereal_t = t;
+	sidereal_lng = loc_lng_d;
+	sidereal_ms = getSiderealMs(t, loc_lng_d);
+}
+
+/**
+ * Sidereal angle from the sidereal clock
+ *
+ * Between seeds the clock is advanced with 32 bit arithmetic only. As
+ * sidereal_max_advance seconds are less than one sidereal day in ms, a single
+ * subtraction replaces the 64 bit modulo of getSiderealAngle(). The result is
+ * identical to getSiderealAngle() to the ms, as both are the same modulo sum.
+ *
+ * @param [in] t a 32 bit value in solar seconds since midnight 01-01-1970.
+ * @param [in] loc_lng_d the longitude of the observer in degrees
+ * @returns sidereal time in rads
+ */
+double getSiderealClock(time_t t, double loc_lng_d)
+{
+	if (sidereal_t == 0 || t < sidereal_t || loc_lng_d != sidereal_lng ||
+		(uint32_t)(t - sidereal_t) > sidereal_max_advance)
+	{
+		syncSiderealClock(t, loc_lng_d);
+	}
+	else
+	{
+		sidereal_ms += (uint32_t)(t - sidereal_t) * 1000ul;
+		if (sidereal_ms >= solar_ms_seconds_per_sidereal_day)
+			sidereal_ms -= solar_ms_seconds_per_sidereal_day;
+		sidereal_t = t;
+	}
+	return getSiderealRads(sidereal_ms);
+}
@@ -1,12 +1,45 @@
 /**
  * @file calibrate.cpp
- * @brief Mode to set pointer calibration, object index, location index and demo
+ * @brief Mode to set pointer calibration, object index, location index,
+ * backlash and demo
  */
 
 #include "calibrate.h"
 
 #include "main.h"
-#include <EEPROM.h>
+
+/**
+ * Measure the backlash of an axis, while the button is held. The pointer
+ * first approaches 0 clockwise, so the gears are engaged. Then the motor
+ * turns back one step every backlash_delay_ms without compensation. The
+ * button is released as soon as the pointer moves, the steps before that
+ * are the backlash. A release during the approach keeps the old backlash.
+ * @param [in] axis 0 is azimuth, 1 is altitude
+ */
+static void measure_backlash(int axis)
+{
+	int old = get_backlash(axis);
+	int steps = 0;
+
+	step_to(axis == 0 ? -48 * step_scale : 0, axis == 0 ? 0 : -48 * step_scale, false);
+	step_to(0, 0, false); // clockwise, gears engaged
+	set_backlash(axis, 0);
+
+	while (!digitalRead(calibrate_pin) && steps <= backlash_max)
+	{
+		steps++;
+		step_to(axis == 0 ? -steps : 0, axis == 0 ? 0 : -steps, false);
+		delay(backlash_delay_ms);
+	}
+	while (!digitalRead(calibrate_pin))
+	{
+	} // wait until the button is released
+
+	// the pointer moved on the last step, it is one step counter clockwise
+	// of 0 with the gears engaged counter clockwise
+	set_backlash(axis, steps > 0 ? steps - 1 : old);
+	step_to(0, 0, false);
+}
 
 /**
  * Calibration mode is activated by holding the calibration button. To resume
@@ -15,7 +48,7 @@
 void calibration_mode()
 {
 
-	int direction = 4; // 4 step increment needed to match enery state
+	int direction = step_cycle; // a coil cycle increment needed to match enery state
 	int mode = 0;	   // switch to azimuth
 	int waitcount = 0;
 	int count; // used to speed up after 80 steps
@@ -46,9 +79,9 @@ void calibration_mode()
 		switch (mode + (!digitalRead(calibrate_pin) ? 3 : (waitcount == 1 ? 0 : (waitcount <= 500 ? 1 : 2))))
 		{
 		case 0:			   // Azimuth, indicated by left-right swing at minimum altitude
-			direction = 4; // reset direction
+			direction = step_cycle; // reset direction
 			step_to(0, altitude_limit, false);
-			step_to(48, altitude_limit, false);
+			step_to(48 * step_scale, altitude_limit, false);
 			step_to(0, altitude_limit, false);
 			break;
 		case 1:
@@ -75,9 +108,9 @@ void calibration_mode()
 			break;
 
 		case 10:		   // Altitude, indicated by up-down swing at horizontal altitude
-			direction = 4; // reset direction
+			direction = step_cycle; // reset direction
 			step_to(0, 0, false);
-			step_to(0, 48, false); // show altitude
+			step_to(0, 48 * step_scale, false); // show altitude
 			step_to(0, 0, false);
 			break;
 		case 11:
@@ -105,7 +138,7 @@ void calibration_mode()
 
 		case 20:								   // Object 0-8 (1-9) sun ... moon ... neptune, 9-11 (10-12) stars
 			step_to(0, 0, false);				   // horizontal
-			beep_calibrate(2, EEPROM.read(1) + 1); // label = 2 beeps
+			beep_calibrate(2, store_get(store_object) + 1); // label = 2 beeps
 			break;
 		case 21:
 			delay(10);
@@ -119,36 +152,72 @@ void calibration_mode()
 			while (!digitalRead(calibrate_pin))
 			{
 			} // wait until key is released
-			object_index = EEPROM.read(1) + 1;
+			object_index = store_get(store_object) + 1;
 			if (object_index > max_object)
 				object_index = 0;
-			EEPROM.write(1, object_index);
+			store_set(store_object, object_index);
+			store_flush(); // a reboot follows calibration
 			beep_calibrate(0, object_index + 1);
 			break;
 
 		case 30: // Location 0 (1) Utrecht, 1 (2) Norkapp, 2 (3) Singapore
 			step_to(0, 0, false);
-			beep_calibrate(3, EEPROM.read(2) + 1); // label = 3 beeps
+			beep_calibrate(3, store_get(store_location) + 1); // label = 3 beeps
 			break;
 		case 31:
 			delay(10);
 			break;
 		case 32:
 			waitcount = 0; // reset timer
-			mode = 100;	   // switch to select demo
+			mode = 40;	   // switch to azimuth backlash
 			break;
 		case 33:		   // key pressed
 			waitcount = 1; // reset the timeout
 			while (!digitalRead(calibrate_pin))
 			{
 			} // wait until key is released
-			location_index = EEPROM.read(2) + 1;
+			location_index = store_get(store_location) + 1;
 			if (location_index > max_location)
 				location_index = 0;
-			EEPROM.write(2, location_index);
+			store_set(store_location, location_index);
+			store_flush(); // a reboot follows calibration
 			beep_calibrate(0, location_index + 1);
 			break;
 
+		case 40: // Azimuth backlash, value is steps + 1
+			step_to(0, 0, false);
+			beep_calibrate(5, get_backlash(0) + 1); // label = 5 beeps
+			break;
+		case 41:
+			delay(10);
+			break;
+		case 42:
+			waitcount = 0; // reset timer
+			mode = 50;	   // switch to altitude backlash
+			break;
+		case 43: // key pressed
+			waitcount = 1;
+			measure_backlash(0);
+			beep_calibrate(0, get_backlash(0) + 1);
+			break;
+
+		case 50: // Altitude backlash, value is steps + 1
+			step_to(0, 0, false);
+			beep_calibrate(6, get_backlash(1) + 1); // label = 6 beeps
+			break;
+		case 51:
+			delay(10);
+			break;
+		case 52:
+			waitcount = 0; // reset timer
+			mode = 100;	   // switch to select demo
+			break;
+		case 53: // key pressed
+			waitcount = 1;
+			measure_backlash(1);
+			beep_calibrate(0, get_backlash(1) + 1);
+			break;
+
 		case 100: // Demo
 			step_to(0, 0, false);
 			beep_calibrate(4, 0); // label = 4 beeps
@@ -167,13 +236,14 @@ void calibration_mode()
 			mode = 104; // switch to rundemo, fall through
 
 		case 104:
-			getLocation(EEPROM.read(2), &lat, &lng);
+			getLocation(store_get(store_location), &lat, &lng);
 			set_lang_long(lat, lng);
 			setSyncProvider(RTC.get);				   // set the time to the RTC
 			setSyncProvider(0);						   // but disable the sync provider
 		case 105:									   // rundemo, no key pressed
 			waitcount = 1;							   // avoid timeout, so state 106 not reached
-			set_pointer(getSiderealAngle(now(), lng)); // update the pointer
+			// update the pointer
+			set_pointer(getSiderealClock(now(), lng), journal_read(0));
 			setTime(now() + 300);					   // advance 5 minutes (but don't update the RTC)
 			break;
 		case 107: // key pressed
@@ -2,27 +2,24 @@
  * @file ds3231.cpp
  * @brief Using NVRAM for motor positions
  *
- * We misuse the alarm registers of the DS3231 as NVRAM.
- * The very precise DS3231 has no additional NVRAM, so we are misusing the bcd
- * values in the alarm registers for that.
+ * The motor positions and the backlash are kept in the key/value store, see
+ * store.cpp, which uses the SRAM of a DS3232 or the alarm registers of a
+ * DS3231.
  *
  * https://github.com/JChristensen/DS3232RTC
  *
- * There are only two register sets (alarm register sets) are available so the
- * only valid values for adr are 0 and 1 (non zero). The allowed value range is
- * -2000 to 42639.
- *
  * All communication is done through the I2C bus, controlled using the
  * Wire.h library. Analog pin A4 (PC4) and A5 (PC5) are used as SDA and SCL
  * respectively.
  *
  * The actual time routines are implemented in the DS3232RTC.h library and no
  * additional code is needed here.
- * The RTC clock is a SyncProvider for the Time.h library implemented in
+ * The RTC clock can be a SyncProvider for the Time.h library implemented in
  * DS3232RTC.h library. The time.h library uses an interval to determine if
  * external sync is needed. However, this interval is measured using Timer0,
- * which is disabled during powerdown. Therefor, the syncprovider should be set
- * in loop () and before now() is called.
+ * which is disabled during powerdown. Therefor, sleep() adds the time asleep
+ * to the clock and time_sync() in loop() reads the RTC instead, see
+ * power.cpp.
  *
  * To ensure power usage is low, the VCC of the DS3231 is wired to a digital
  * pin of the arduino. Whenever the RTC or NVRAM is used, call power_on() first
@@ -33,47 +30,80 @@
  * rtc_on ();              // don't forget to power on
  * setTime (12, 39, 0, 13, 8, 2016); // hour, min, sec, day, month, year
  * RTC.set (now ());         // transfer to RTC
+ *
+ * Writing the position after every step costs an I2C transaction per step.
+ * The motor positions are therefore journaled: they are kept in RAM and
+ * written behind to the NVRAM
+ * - at the end of every move (step_to())
+ * - when a position ran journal_steps ahead of its NVRAM copy
+ * - in power_off(), before the RTC loses power
+ * The NVRAM is exact whenever the pointer is at rest. If power fails during
+ * a move, the NVRAM position is at most journal_steps behind the pointer,
+ * which the next calibration corrects. A low battery stops the tracker
+ * between moves (see loop()), so a brownout does not add to that.
+ *
+ * The backlash of each motor is kept in a byte of its own, in steps.
  */
 
 #include "ds3231.h"
 
-#define ALRM0	0x08					      // Alarm register 0
-#define ALRM1	0x0b					      // Alarm register 1
+#include "store.h"
 
 /**
- * mhd is maintained as a global to allow testing without a RTC present
+ * position journal, see above. The positions in RAM are those of the store.
  */
-uint8_t mhd[3] = {0, 0, 0};				// minute-hour-day
+static int journal_pending[2];     // steps not yet in NVRAM
 
 /**
- * Get value
+ * Get a motor position, from RAM once it was read from NVRAM
  * @param [in] adr register 0 or 1
  * @returns value
  */
-int rtcRead (int adr)
+int journal_read (int adr)
 {
-  uint16_t uvalue;
-  // read from alarm registers 1 or 2
-  RTC.readRTC (adr == 0 ? ALRM0 : ALRM1, mhd, 3);
-  //    day in month               hour           min
-  uvalue = (mhd[2] - 1) * (60 * 24) + (mhd[1] * 60) + mhd[0];
-  // slight negative allowed for slop processing
-  return uvalue - 2000;
+  return store_get (adr == 0 ? store_azimuth : store_altitude);
 }
 
 /**
- * Set value
+ * Set a motor position in RAM, write it to NVRAM when it ran journal_steps
+ * ahead
  * @param [in] adr register 0 or 1
  * @param [in] value
  */
-void rtcWrite (int adr, int value)
+void journal_write (int adr, int value)
+{
+  adr = adr != 0;
+  store_set (adr == 0 ? store_azimuth : store_altitude, value);
+  if (++journal_pending[adr] >= journal_steps)
+    journal_flush ();
+}
+
+/**
+ * Write the positions that changed to NVRAM, in a single burst
+ */
+void journal_flush ()
+{
+  store_flush ();
+  journal_pending[0] = 0;
+  journal_pending[1] = 0;
+}
+
+/**
+ * Get the backlash of a motor
+ * @param [in] adr motor 0 or 1
+ * @returns backlash in steps
+ */
+int backlash_read (int adr)
+{
+  return store_get (store_backlash + (adr != 0));
+}
+
+/**
+ * Set the backlash of a motor
+ * @param [in] adr motor 0 or 1
+ * @param [in] value backlash in steps, 0 to backlash_max
+ */
+void backlash_write (int adr, int value)
 {
-  uint16_t uvalue;
-  // slight negative allowed for slop processing
-  uvalue = value + 2000;
-  mhd[0] = uvalue % 60;                 // min
-  mhd[1] = (uvalue / 60) % 24;          // hour
-  mhd[2] = 1 + (uvalue / (60 * 24));    // day in month
-  // write to alarm registers 1 or 2
-  RTC.writeRTC (adr == 0 ? ALRM0 : ALRM1, mhd, 3);
+  store_set (store_backlash + (adr != 0), constrain (value, 0, backlash_max));
 }
@@ -0,0 +1,170 @@
+/**
+ * @file fasttrig.cpp
+ * @brief Fixed point sin, cos and atan2 for the AVR
+ *
+ * On the AVR a double is a 32 bit float and every sin, cos or atan2 of
+ * avr-libc costs a few thousand cycles. Here the angle is converted once to
+ * a 24 bit binary angle (trig_units per turn). The quadrant comes from the
+ * top two bits, the rest is evaluated with a minimax polynomial in 16.16
+ * unsigned fixed point. All products fit in 32 bits, so only the hardware
+ * multiplier is needed. atan2 works the same way on the ratio of the
+ * smaller and the larger of |x| and |y|.
+ *
+ * The coefficients were fitted for the least maximum error on [0, 1]:
+ * - sin(pi / 2 * z), odd polynomial of degree 7, 0.12"
+ * - atan(t), odd polynomial of degree 9, 2.4"
+ * Rounding to 16.16 adds to that. Over all 2^24 binary angles sin and cos
+ * are within 9.0", and 9.1" for any angle in rads, which is truncated to a
+ * binary angle first. atan2 and atan are within 13". See tools/trigcheck.cpp,
+ * which measures them against the double precision library.
+ *
+ * sqrt is left to avr-libc, which is already fast.
+ *
+ * The code only needs math.h and stdint.h, so it can be checked on a host.
+ */
+
+#include "fasttrig.h"
+
+#define trig_one 65536ul // 1.0 in 16.16
+
+/**
+ * sin(pi / 2 * z) in 16.16, coefficients in 0.16
+ */
+#define sin_c1 102944ul // 1.5707910
+#define sin_c3 42329ul	// 0.6458928
+#define sin_c5 5206ul	// 0.0794343
+#define sin_c7 284ul	// 0.0043331
+
+/**
+ * atan(t) in rads in 16.16, coefficients in 0.16
+ */
+#define atan_c1 65527ul // 0.9998663
+#define atan_c3 21647ul // 0.3303048
+#define atan_c5 11807ul // 0.1801593
+#define atan_c7 5581ul	// 0.0851563
+#define atan_c9 1366ul	// 0.0208451
+
+#define atan_pi 205887l		 // pi in 16.16
+#define atan_half_pi 102944l // pi / 2 in 16.16
+#define atan_quarter_pi 51472l // pi / 4 in 16.16
+
+/**
+ * sin for the first quadrant
+ * @param [in] z 0 to trig_one for 0 to 90 degrees
+ * @returns sin in 16.16
+ */
+static uint32_t sinQuadrant(uint32_t z)
+{
+	if (z >= trig_one)
+		return trig_one;
+
+	uint32_t z2 = (z * z + 0x8000) >> 16;
+	uint32_t p = sin_c5 - ((z2 * sin_c7 + 0x8000) >> 16);
+	p = sin_c3 - ((z2 * p + 0x8000) >> 16);
+	p = sin_c1 - ((z2 * p + 0x8000) >> 16);
+	return ((z >> 1) * p + 0x4000) >> 15; // z * p may exceed 32 bits
+}
+
+/**
+ * sin of a binary angle
+ * @param [in] a angle in trig_units per turn, any number of turns
+ * @returns sin
+ */
+static double sinUnits(int32_t a)
+{
+	uint32_t u = (uint32_t)a + 32; // round to 16 bits in the quadrant
+	uint32_t z = (u >> 6) & 0xffff;
+	uint32_t s;
+
+	if (u & 0x400000ul)
+		s = sinQuadrant(trig_one - z); // second and fourth quadrant
+	else
+		s = sinQuadrant(z);
+
+	if (u & 0x800000ul)
+		return -(double)s / trig_one; // third and fourth quadrant
+	return (double)s / trig_one;
+}
+
+/**
+ * Convert rads to a binary angle
+ * @param [in] x angle in rads
+ * @returns angle in trig_units per turn
+ */
+static int32_t toUnits(double x)
+{
+	if (x > trig_reduce || x < -trig_reduce)
+		x -= floor(x / (2 * M_PI)) * (2 * M_PI);
+	return (int32_t)(x * (trig_units / (2 * M_PI)));
+}
+
+/**
+ * @param [in] x angle in rads
+ * @returns sin(x)
+ */
+double fastSin(double x)
+{
+	return sinUnits(toUnits(x));
+}
+
+/**
+ * @param [in] x angle in rads
+ * @returns cos(x)
+ */
+double fastCos(double x)
+{
+	return sinUnits(toUnits(x) + (int32_t)(trig_units / 4));
+}
+
+/**
+ * atan for the first octant
+ * @param [in] t 0 to trig_one for tangent 0 to 1
+ * @returns atan in rads in 16.16
+ */
+static uint32_t atanOctant(uint32_t t)
+{
+	if (t >= trig_one)
+		return atan_quarter_pi;
+
+	uint32_t t2 = (t * t + 0x8000) >> 16;
+	uint32_t p = atan_c7 - ((t2 * atan_c9 + 0x8000) >> 16);
+	p = atan_c5 - ((t2 * p + 0x8000) >> 16);
+	p = atan_c3 - ((t2 * p + 0x8000) >> 16);
+	p = atan_c1 - ((t2 * p + 0x8000) >> 16);
+	return (t * p + 0x8000) >> 16;
+}
+
+/**
+ * @param [in] y y coordinate
+ * @param [in] x x coordinate
+ * @returns angle of (x, y) in rads, -pi to pi
+ */
+double fastAtan2(double y, double x)
+{
+	double ax = fabs(x);
+	double ay = fabs(y);
+	int32_t r;
+
+	if (ax == 0.0 && ay == 0.0)
+		return 0.0;
+
+	if (ay <= ax)
+		r = atanOctant((uint32_t)(ay / ax * trig_one + 0.5));
+	else
+		r = atan_half_pi - atanOctant((uint32_t)(ax / ay * trig_one + 0.5));
+
+	if (x < 0.0)
+		r = atan_pi - r;
+	if (y < 0.0)
+		r = -r;
+	return (double)r / trig_one;
+}
+
+/**
+ * @param [in] z tangent
+ * @returns atan(z) in rads, -pi / 2 to pi / 2
+ */
+double fastAtan(double z)
+{
+	return fastAtan2(z, 1.0);
+}
@@ -19,13 +19,6 @@
  * includes
  */
 #include "main.h"
-#include <EEPROM.h>
-
-/**
- * object, ecliptic ra/dc coorinates in hours/degrees
- */
-double object_ra;
-double object_dc;
 
 /**
  * observers location
@@ -44,38 +37,41 @@ boolean stop = false;
  */
 void setup()
 {
-  if (EEPROM.read(0) != '#')
-  { // check validity of EEPROM
-    EEPROM.write(0, '#');
-    EEPROM.write(1, 0);
-    EEPROM.write(2, 0);
-    EEPROM.write(3, 0);
-  }
-  beep_calibrate(0, EEPROM.read(1) + 1); // indicate the object
+  pinMode(rtc_power_pin, OUTPUT); // enable RTC power pin
+  power_on();                     // power up peripherals inc Serial, the store
+
+  beep_calibrate(0, store_get(store_object) + 1);   // indicate the object
   delay(400);
-  beep_calibrate(0, EEPROM.read(2) + 1); // and location
+  beep_calibrate(0, store_get(store_location) + 1); // and location
 
-  for (int n = 0; n <= 3; n++) // enable motor pins
-  {
-    pinMode(motor_pin_azimuth + n, OUTPUT);
-    pinMode(motor_pin_altitude + n, OUTPUT);
-  }
+  step_begin(); // enable motor pins
 
-  pinMode(rtc_power_pin, OUTPUT);     // enable RTC power pin
-  power_on();                         // power up peripherals inc Serial
-  RTC.writeRTC(0x10, EEPROM.read(3)); // get aging from EEPROM and write to RTC
+  RTC.writeRTC(0x10, store_get(store_aging)); // aging from the store to the RTC
 
 #ifdef SERIAL_BPS
   Serial.println("start");
+#ifdef SATELLITE
+  satelliteSerial(); // optionally load a TLE
+#endif
+#ifdef MINOR_BODIES
+  minorSerial(); // optionally load comet or asteroid elements
+#endif
+  agingSerial(); // optionally compare the RTC with a reference time
+#ifdef MOTOR_BENCH
+  step_bench(); // cycles per step of the motor drivers
+#endif
 #endif
 
-  step_to(steps_per_revolution / 2, 0, false);     // check for free running pointer
-  delay(500);                                      // easier for altitude (horizontal)
-  step_to(0, altitude_limit, false);               // check full (halfway, 0) calibration
-  delay(500);                                      // easier for altitude (horizontal)
-  step_to(-steps_per_revolution / 2, 0, false);    // check for free running pointer
-  delay(500);                                      // also easier to see azimuth zero
-  getLocation(EEPROM.read(2), &loc_lat, &loc_lng); // set lat/long of the observer
+  step_to(steps_per_revolution / 2, 0, false);                // check for free running pointer
+  delay(500);                                                 // easier for altitude (horizontal)
+  step_to(0, altitude_limit, false);                          // check full (halfway, 0) calibration
+  delay(500);                                                 // easier for altitude (horizontal)
+  step_to(-steps_per_revolution / 2, 0, false);               // check for free running pointer
+  delay(500);                                                 // also easier to see azimuth zero
+  getLocation(store_get(store_location), &loc_lat, &loc_lng); // set lat/long of the observer
+#ifdef SERIAL_BPS
+  skySerial(RTC.get(), loc_lat, loc_lng, store_get(store_object)); // the stars up now
+#endif
 }
 
 /**
@@ -83,24 +79,93 @@ void setup()
  */
 void loop()
 {
+  unsigned long seconds = sleep_default; // time to the next update
+
   if (stop) // a stop is final
   {
     beep(50, 0); // warn user
   }
   else if (battery_check()) // if there is enough power
   {
-    // Set the plugin function to get the time from the RTC. As the processor
-    // is powered down, including Timer0, the SyncProvider needs to be set
-    // in the loop() as it forces a resync of the the Time.
-    setSyncProvider(RTC.get);
-    set_pointer(getSiderealAngle(now(), loc_lng)); // update the pointer
+    // sleep() added the time asleep, as the processor is powered down
+    // including Timer0. The RTC is only read when the time may have drifted.
+    time_sync();
+    seconds = update_pointer();
+    aging_update(now()); // drift of the RTC against temperature
   }
   else
   {
     beep(50, 0);
     stop = true; // set the stop state
   }
-  sleep(); // ultra low power state
+  sleep(seconds); // ultra low power state
+}
+
+/**
+ * Update the pointer from the compiled trajectory. Without a trajectory, i.e.
+ * at start up or when the object rises, the pointer is set by computing the
+ * position and a new trajectory is compiled.
+ * @returns seconds to sleep
+ */
+unsigned long update_pointer()
+{
+  time_t t = now();
+  int az_ticks;
+  int al_ticks;
+
+#ifdef SATELLITE
+  if (store_get(store_object) == object_satellite)
+    return satellite_pass();
+#endif
+
+  // events due before the next wake up are taken now
+  if (trajectory_pop(t + sleep_granularity, &az_ticks, &al_ticks))
+  {
+    step_to(az_ticks, al_ticks, false);
+  }
+  else if (trajectory_wake() == 0)
+  {
+    // a new pass starts from the middle of the cable wrap budget
+    if (set_pointer(getSiderealClock(t, loc_lng), 0) < riseset_horizon)
+      return sleep_to_rise(); // nothing to follow until it rises
+    trajectory_start(t, loc_lng);
+  }
+
+  t = trajectory_wake();
+  if (t == 0)
+    return sleep_default; // the object sets
+  return t > now() ? t - now() : 0;
+}
+
+#ifdef SATELLITE
+/**
+ * Follow a satellite pass. A satellite crosses the sky in minutes, so the
+ * pointer is updated every pass_interval_ms without sleeping, until the
+ * satellite sets.
+ * @returns seconds to sleep
+ */
+unsigned long satellite_pass()
+{
+  while (set_pointer(getSiderealClock(now(), loc_lng), journal_read(0)) >= riseset_horizon)
+    delay(pass_interval_ms);
+  return sleep_to_rise();
+}
+#endif
+
+/**
+ * Seconds to sleep while the object is below the horizon. Wakes one update
+ * before the rise, so the pointer is in place when the object rises. If it
+ * does not rise within the search window, sleep the whole window.
+ */
+unsigned long sleep_to_rise()
+{
+  time_t rise = getRise(store_get(store_object), now(), loc_lat, loc_lng, riseset_horizon);
+
+  if (rise == 0)
+    return riseset_window;
+  if (rise < now() + 2 * sleep_default)
+    return sleep_default;
+  return rise - now() - sleep_default;
 }
 
 /**
@@ -113,31 +178,29 @@ void set_lang_long(double lat, double lng)
 }
 
 /**
- * the real work
+ * Get the pointer position for the object
  * - gets the RA and DC of the object
  * - transforms it to AZ and AL
- * - rotates the pointer
+ * - converts to motor ticks
+ * @param [in] t time in UTC
+ * @param [in] sidereal_r Sidereal time units: rads
+ * @param [in] az_from azimuth in motor ticks the pointer comes from
+ * @param [out] az_ticks azimuth of object in motor ticks
+ * @param [out] al_ticks altitude of object in motor ticks, limited
+ * @param [out] az_steps azimuth in steps before truncation to ticks, optional
+ * @param [out] al_steps altitude in steps before truncation and limit, optional
+ * @param [in] cached use the cached position, see getHorizontal()
+ * @returns altitude of the object in degrees
  */
-void set_pointer(double sidereal_r)
+double get_ticks(time_t t, double sidereal_r, int az_from, int *az_ticks, int *al_ticks,
+                 double *az_steps, double *al_steps, bool cached)
 {
   double object_az_d; // azimuth of object in degrees
   double object_al_d; // altitude of object in degrees
-  int az_ticks;       // azimuth of object in motor ticks
-  int al_ticks;       // altitude of object in motor ticks
-
-  getObject(EEPROM.read(1), now(), &object_ra, &object_dc); // get object RA and DecC
 
-  transform(object_ra, object_dc, // transform to AZ and AL
-            loc_lat, sidereal_r,
-            &object_az_d, &object_al_d);
-
-#ifdef SERIAL_POS
-  Serial.print("az/al:");
-  Serial.print(object_az_d);
-  Serial.print(", ");
-  Serial.println(object_al_d);
-  delay(20);
-#endif
+  getHorizontal(store_get(store_object), t, // get object AZ and AL
+                loc_lat, sidereal_r,
+                &object_az_d, &object_al_d, cached);
 
   // transform azimuth from 0 - 360 to 0 - 180, - 180 - 0
   // reason is stars hover in the northern azimuthal grid if they have
@@ -146,13 +209,51 @@ void set_pointer(double sidereal_r)
   if (object_az_d > 180.0)
     object_az_d -= 360.0;
 
-  // motor rotates counter azimuth
-  az_ticks = -object_az_d * steps_per_revolution / 360.0;
-  al_ticks = object_al_d * steps_per_revolution / 360.0;
+  // motor rotates counter azimuth, take the turn closest to az_from within
+  // the cable wrap budget
+  double az = -object_az_d * steps_per_revolution / 360.0;
+  double al = object_al_d * steps_per_revolution / 360.0;
+  *az_ticks = step_wrap(az, az_from);
+  *al_ticks = al;
+  if (az_steps) // in the same turn as az_ticks
+    *az_steps = az + (*az_ticks - (int)az);
+  if (al_steps)
+    *al_steps = al;
   // protect the pointer
-  if (al_ticks < altitude_limit)
-    al_ticks = altitude_limit;
+  if (*al_ticks < altitude_limit)
+    *al_ticks = altitude_limit;
+
+  return object_al_d;
+}
+
+/**
+ * the real work
+ * - gets the pointer position of the object
+ * - rotates the pointer
+ * @returns altitude of the object in degrees
+ */
+double set_pointer(double sidereal_r, int az_from)
+{
+  double object_al_d; // altitude of object in degrees
+  int az_ticks;       // azimuth of object in motor ticks
+  int al_ticks;       // altitude of object in motor ticks
+
+#ifdef SERIAL_POS
+  double az_steps; // exact azimuth in steps
+  double al_steps; // exact altitude in steps
+
+  object_al_d = get_ticks(now(), sidereal_r, az_from, &az_ticks, &al_ticks,
+                          &az_steps, &al_steps);
+  Serial.print("az/al:");
+  Serial.print(fmod(720.0 - az_steps * 360.0 / steps_per_revolution, 360.0));
+  Serial.print(", ");
+  Serial.println(al_steps * 360.0 / steps_per_revolution);
+  delay(20);
+#else
+  object_al_d = get_ticks(now(), sidereal_r, az_from, &az_ticks, &al_ticks);
+#endif
 
   // set pointer
   step_to(az_ticks, al_ticks, false);
+  return object_al_d;
 }
@@ -0,0 +1,263 @@
+/**
+ * @file orbit.cpp
+ * @brief Heliocentric orbits and the path from the sun to the observer
+ *
+ * The sun's position and the rotation from ecliptic to equatorial
+ * coordinates are shared by the planets in getPlanet() and the comets and
+ * asteroids, which are given by their orbital elements.
+ *
+ * All math from http://www.stjarnhimlen.se/comp/ppcomp.html, sections 4, 5,
+ * 12, 17, 18 and 19.
+ *
+ * Apart from minorElements() and minorSerial() this file only needs
+ * math.h, so it can be compiled on a host as well, e.g. by the planning
+ * tool in tools/mpcelements.cpp.
+ */
+
+#include "orbit.h"
+
+#include "fasttrig.h"
+
+/**
+ * Position of the sun, which is the position of the earth seen from the
+ * sun turned around by 180 degrees
+ * http://www.stjarnhimlen.se/comp/ppcomp.html#4
+ * http://www.stjarnhimlen.se/comp/ppcomp.html#5
+ *
+ * @param [in] d days since 31-12-1999T00:00:00
+ * @param [out] Ms Mean Anomaly of the Sun (earth) in rads
+ * @param [out] ws Argument of perihelion for the Sun in rads
+ * @param [out] lonsun Sun's true longitude in rads
+ * @param [out] rs Sun's distance in AU
+ */
+void orbitSun(double d, double *Ms, double *ws, double *lonsun, double *rs)
+{
+	double ecs; // Sun (earth) eccentricity
+	double Es;	// Sun (earth) eccentric anomaly
+	double xv, yv;
+
+	// Ns = 0.0, is = 0.0 and as = 1.0 (AU)
+	*ws = 4.93824156690976 + 8.219366312880E-7 * d; // 282.9404 + 4.70935E-05 * d
+	ecs = 0.016709 - 1.151E-09 * d;
+	*Ms = 6.21419244184825 + 1.720196961933E-2 * d; // 356.047 + 0.9856002585 * d
+
+	Es = *Ms + ecs * trig_sin(*Ms) * (1.0 + ecs * trig_cos(*Ms));
+	xv = trig_cos(Es) - ecs;
+	yv = sqrt(1.0 - ecs * ecs) * trig_sin(Es);
+
+	*lonsun = trig_atan2(yv, xv) + *ws;
+	*rs = sqrt(xv * xv + yv * yv);
+}
+
+/**
+ * Heliocentric ecliptic position of a comet or asteroid. The elements are
+ * J2000, the position is turned to the equinox of date by adding the
+ * precession to the node, which is how the planets' elements are given.
+ *
+ * Below and above near_parabolic the usual elliptic and hyperbolic Kepler
+ * equations are solved with Newton's method, which uses the float library
+ * also with FAST_TRIG, as it iterates to well below the error of fastSin().
+ * Near parabolic orbits use the series of
+ * http://www.stjarnhimlen.se/comp/ppcomp.html#19, which is Barker's equation
+ * for e = 1. Its error grows quickly with |e - 1|, near_parabolic is about
+ * where it meets the float cancellation of a * (cos(Eo) - e) for a large a,
+ * see tools/orbitcheck.cpp.
+ *
+ * @param [in] el orbital elements
+ * @param [in] d days since 31-12-1999T00:00:00
+ * @param [out] xh x in AU, towards the equinox of date
+ * @param [out] yh y in AU
+ * @param [out] zh z in AU, towards the ecliptic north pole
+ */
+void orbitHeliocentric(const orbit_elements *el, double d,
+					   double *xh, double *yh, double *zh)
+{
+	double e = el->e;
+	double q = el->q;
+	double t = d - el->tp; // days since perihelion
+	double vo;			   // true anomaly
+	double ro;			   // distance to the sun in AU
+
+	if (e < 1.0 - near_parabolic)
+	{ // ellipse
+		double a = q / (1.0 - e);
+		double Mo = gaussian_k / (a * sqrt(a)) * t;
+		double Eo;
+
+		Mo = fmod(Mo, 2 * pi);
+		if (Mo > pi)
+			Mo -= 2 * pi;
+		else if (Mo < -pi)
+			Mo += 2 * pi;
+
+		// Danby's starting value converges for all e < 1
+		Eo = Mo + (Mo < 0.0 ? -0.85 : 0.85) * e;
+		for (int n = 0; n < 20; n++)
+		{
+			double delta = (Eo - e * sin(Eo) - Mo) / (1.0 - e * cos(Eo));
+			Eo -= delta;
+			if (fabs(delta) < 1e-6)
+				break;
+		}
+
+		// a * (cos(Eo) - e) cancels near perihelion of a long orbit, which
+		// would multiply the error of fastCos() by a
+		double xv = a * (cos(Eo) - e);
+		double yv = a * sqrt(1.0 - e * e) * sin(Eo);
+		vo = trig_atan2(yv, xv);
+		ro = sqrt(xv * xv + yv * yv);
+	}
+	else if (e > 1.0 + near_parabolic)
+	{ // hyperbola
+		double a = q / (e - 1.0);
+		double Mo = gaussian_k / (a * sqrt(a)) * t;
+		double Fo = log(Mo / e + sqrt(Mo * Mo / (e * e) + 1.0)); // asinh
+
+		for (int n = 0; n < 20; n++)
+		{
+			double delta = (e * sinh(Fo) - Fo - Mo) / (e * cosh(Fo) - 1.0);
+			Fo -= delta;
+			if (fabs(delta) < 1e-6)
+				break;
+		}
+
+		vo = 2.0 * trig_atan(sqrt((e + 1.0) / (e - 1.0)) * tanh(Fo / 2.0));
+		ro = a * (e * cosh(Fo) - 1.0);
+	}
+	else
+	{ // near parabolic
+		double A = 0.75 * t * gaussian_k * sqrt((1.0 + e) / (q * q * q));
+		double B = sqrt(1.0 + A * A);
+		double W = cbrt(B + A) - cbrt(B - A);
+		double W2 = W * W;
+		double f = (1.0 - e) / (1.0 + e);
+		double a1 = (2.0 / 3.0) + (2.0 / 5.0) * W2;
+		double a2 = (7.0 / 5.0) + (33.0 / 35.0) * W2 + (37.0 / 175.0) * W2 * W2;
+		double a3 = W2 * ((432.0 / 175.0) + (956.0 / 1125.0) * W2 + (84.0 / 1575.0) * W2 * W2);
+		double C = W2 / (1.0 + W2);
+		double g = f * C * C;
+		double w = W * (1.0 + f * C * (a1 + a2 * g + a3 * g * g));
+
+		vo = 2.0 * trig_atan(w);
+		ro = q * (1.0 + w * w) / (1.0 + w * w * f);
+	}
+
+	// http://www.stjarnhimlen.se/comp/ppcomp.html#7
+	double No = el->node + precession_per_day * d;
+	double uo = vo + el->peri;
+
+	*xh = ro * (trig_cos(No) * trig_cos(uo) - trig_sin(No) * trig_sin(uo) * trig_cos(el->i));
+	*yh = ro * (trig_sin(No) * trig_cos(uo) + trig_cos(No) * trig_sin(uo) * trig_cos(el->i));
+	*zh = ro * (trig_sin(uo) * trig_sin(el->i));
+}
+
+/**
+ * Rotate geocentric ecliptic coordinates to RA and DC
+ * http://www.stjarnhimlen.se/comp/ppcomp.html#12
+ *
+ * @param [in] d days since 31-12-1999T00:00:00
+ * @param [in] xg x towards the equinox of date
+ * @param [in] yg y
+ * @param [in] zg z towards the ecliptic north pole
+ * @param [out] object_ra Right Ascention in hours
+ * @param [out] object_dc Declination in degrees
+ */
+void orbitEquatorial(double d, double xg, double yg, double zg,
+					 double *object_ra, double *object_dc)
+{
+	double xe, ye, ze; // g-vector converted after ecliptic rotation
+
+	// obliquity of ecliptic of date
+	double ecl = 0.409092959362707 + 6.218608124856E-9 * d; // 23.4393 - 0.0000003563 * d;
+	xe = xg;
+	ye = yg * trig_cos(ecl) - zg * trig_sin(ecl);
+	ze = yg * trig_sin(ecl) + zg * trig_cos(ecl);
+
+	// geocentric RA and Dec
+	*object_ra = trig_atan2(ye, xe) * 12.0 / pi;
+	if (*object_ra < 0.0)
+		*object_ra += 24.0;
+	*object_dc = trig_atan(ze / sqrt(xe * xe + ye * ye)) * 180 / pi;
+}
+
+/**
+ * Geocentric positions of many comets or asteroids at a single moment, for
+ * planning on a host. The sun is computed only once.
+ *
+ * @param [in] el count orbital elements
+ * @param [in] count number of elements
+ * @param [in] d days since 31-12-1999T00:00:00
+ * @param [out] pos count positions
+ */
+void orbitBatch(const orbit_elements *el, int count, double d, orbit_position *pos)
+{
+	double Ms, ws, lonsun, rs;
+	double xh, yh, zh;
+
+	orbitSun(d, &Ms, &ws, &lonsun, &rs);
+	double xs = rs * trig_cos(lonsun);
+	double ys = rs * trig_sin(lonsun);
+
+	for (int n = 0; n < count; n++)
+	{
+		orbitHeliocentric(&el[n], d, &xh, &yh, &zh);
+		double xg = xh + xs;
+		double yg = yh + ys;
+
+		orbitEquatorial(d, xg, yg, zh, &pos[n].ra, &pos[n].dc);
+		pos[n].r = sqrt(xh * xh + yh * yh + zh * zh);
+		pos[n].delta = sqrt(xg * xg + yg * yg + zh * zh);
+	}
+}
+
+#ifdef ARDUINO
+
+#include <EEPROM.h>
+#include "astronomy.h"
+
+#ifdef MINOR_BODIES
+/**
+ * Read the elements of a minor body from EEPROM
+ *
+ * @param [in] slot 0 to MINOR_BODIES - 1
+ * @param [out] el orbital elements
+ */
+void minorElements(int slot, orbit_elements *el)
+{
+	EEPROM.get(minor_eeprom + slot * sizeof(orbit_elements), *el);
+}
+
+#ifdef SERIAL_BPS
+/**
+ * Read minor body elements from Serial and store them in EEPROM. Each
+ * record, as printed by tools/mpcelements.cpp, is one line
+ * m slot tp q e i node peri
+ * with the angles in degrees. Reading stops when nothing arrives for a few
+ * seconds.
+ */
+void minorSerial()
+{
+	orbit_elements el;
+
+	Serial.setTimeout(5000);
+	while (Serial.find((char *)"m"))
+	{
+		int slot = Serial.parseInt();
+		el.tp = Serial.parseFloat();
+		el.q = Serial.parseFloat();
+		el.e = Serial.parseFloat();
+		el.i = Serial.parseFloat() / 180.0 * pi;
+		el.node = Serial.parseFloat() / 180.0 * pi;
+		el.peri = Serial.parseFloat() / 180.0 * pi;
+		if (slot >= 0 && slot < MINOR_BODIES && el.q > 0.0)
+		{
+			EEPROM.put(minor_eeprom + slot * sizeof(orbit_elements), el);
+			clearHorizontalCache();
+			Serial.println(slot);
+		}
+	}
+}
+#endif
+#endif
+
+#endif
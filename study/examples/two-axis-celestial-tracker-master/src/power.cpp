@@ -7,6 +7,12 @@
  * - TwoWire (I2C) is disabled / enabled at sleep / wakeup
  * - TwoWire lines pullup resistors are disabled / enabled at sleep / wakeup
  * - Power to the RTC is removed / reinstalled at sleep / wakeup
+ * - The RTC registers are cached while it has power, so a wake up reads them
+ *   in one burst and writes the changed ones back in power_off()
+ * - The calibrate button wakes the processor by a pin change interrupt, and
+ *   with RTC_ALARM the alarm of the RTC does, see power.h
+ * - The time asleep is added to the software clock, so a wake up does not
+ *   need to read the time from the RTC, see time_sync()
  * The power routines are only called by sleep() (and once power_on in setup),
  * so there is no attempt to do smart power management by the (very short)
  * wakeup periods.
@@ -16,26 +22,224 @@
 
 #include "power.h"
 
+#include "ds3231.h"
+#include "store.h"
+#include <avr/sleep.h>
+
+#define CONTROL 0x0e // control register of the RTC
+#define BBSQW 0x40	 // INT/SQW also works on the backup battery
+#define INTCN 0x04	 // INT/SQW is the alarm interrupt
+
+static time_t sync_last = 0;			  // last read of the RTC time, 0 forces one
+static unsigned int sync_interval = 0;	  // 0 until the slices are measured
+static unsigned long credit_ms = 0;		  // time asleep below a second
+static long slice_ms = sleep_granularity * 1000L; // measured watchdog slice
+static time_t measure_rtc = 0;			  // RTC time at the start, 0 for none
+static unsigned long measure_ms;		  // millis() then, it counts awake only
+static unsigned int measure_slices;		  // slices slept since
+
+// a pin change only wakes the processor, sleep() checks the pins
+EMPTY_INTERRUPT(PCINT0_vect) // calibrate_pin 10, PB2
+#ifdef RTC_ALARM
+EMPTY_INTERRUPT(PCINT1_vect) // rtc_alarm_pin A3, PC3
+#endif
+
+/**
+ * Enable or disable the pin change interrupt of a pin
+ * @param [in] pin Arduino pin
+ * @param [in] enable
+ */
+static void pin_change(uint8_t pin, boolean enable)
+{
+	if (enable)
+	{
+		*digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+		PCIFR = _BV(digitalPinToPCICRbit(pin)); // forget older changes
+		*digitalPinToPCICR(pin) |= _BV(digitalPinToPCICRbit(pin));
+	}
+	else
+	{
+		*digitalPinToPCMSK(pin) &= ~_BV(digitalPinToPCMSKbit(pin));
+		if (!*digitalPinToPCMSK(pin))
+			*digitalPinToPCICR(pin) &= ~_BV(digitalPinToPCICRbit(pin));
+	}
+}
+
+#ifdef RTC_ALARM
 /**
- * Sleep the processor for 40 seconds
+ * @returns the alarm that wakes the processor: alarm 1 on a DS3232, alarm 2
+ * on a DS3231, of which the store leaves only the minutes and hours free
  */
-void sleep()
+static byte alarm_number()
 {
+	return store_sram() ? ALARM_1 : ALARM_2;
+}
+
+/**
+ * Set the alarm of the RTC, on INT/SQW also without power. Alarm 1 of a
+ * DS3232 is set to the second of the wake up. Alarm 2 of a DS3231 matches
+ * hours and minutes only, see store.cpp. It is set to the whole minute
+ * before the wake up, sleep() sleeps the seconds after it by the watchdog.
+ * The registers are written by power_off().
+ * @param [in] wake time to wake up
+ * @returns time the alarm goes off, 0 if it would be within alarm_margin
+ */
+static time_t alarm_set(time_t wake)
+{
+	byte number = alarm_number();
+
+	if (number == ALARM_1)
+		RTC.setAlarm(ALM1_MATCH_DATE, second(wake), minute(wake), hour(wake), day(wake));
+	else
+	{
+		wake -= second(wake);
+		if (wake < now() + alarm_margin)
+			return 0;
+		store_alarm(minute(wake), hour(wake)); // with the positions
+	}
+	RTC.alarm(number); // clear the flag, which releases INT/SQW
+	RTC.alarmInterrupt(ALARM_1, number == ALARM_1);
+	RTC.alarmInterrupt(ALARM_2, number == ALARM_2);
+	RTC.writeRTC(CONTROL, RTC.readRTC(CONTROL) | BBSQW | INTCN);
+	return wake;
+}
+
+/**
+ * Power down until the alarm or the calibrate button pulls its pin low. The
+ * pins are read with interrupts disabled and sei() only takes effect after
+ * sleep_cpu(), so a change in between still wakes the processor.
+ * @returns true if the calibrate button was pushed
+ */
+static boolean alarm_wait()
+{
+	uint8_t adc = ADCSRA;
+	boolean button;
+
+	ADCSRA = 0; // ADC off
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	for (;;)
+	{
+		cli();
+		button = !digitalRead(calibrate_pin);
+		if (button || !digitalRead(rtc_alarm_pin))
+			break;
+		sleep_enable();
+		sleep_bod_disable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+	}
+	sei();
+	ADCSRA = adc;
+	return button;
+}
+#endif
+
+/**
+ * Sleep the processor. With RTC_ALARM the alarm of the RTC wakes it, see
+ * alarm_set(), else the watchdog every sleep_granularity seconds. The
+ * calibrate button wakes it by a pin change at any time.
+ * @param [in] seconds to sleep, the watchdog rounds down to a multiple of
+ * sleep_granularity
+ */
+void sleep(unsigned long seconds)
+{
+#ifdef RTC_ALARM
+	if (seconds > alarm_window) // wakes early, loop() sleeps again
+		seconds = alarm_window;
+	time_t wake = now() + seconds;
+	time_t alarm = seconds >= alarm_margin ? alarm_set(wake) : 0;
+	if (alarm)
+	{
+		pinMode(rtc_alarm_pin, INPUT_PULLUP);
+		pin_change(rtc_alarm_pin, true);
+	}
+#endif
+	pinMode(calibrate_pin, INPUT_PULLUP);
+	pin_change(calibrate_pin, true);
 	power_off();
-	for (int n = 10; n--;)
+
+	boolean button = false;
+#ifdef RTC_ALARM
+	if (alarm)
 	{
-		pinMode(calibrate_pin, INPUT);
-		digitalWrite(calibrate_pin, HIGH); // enable pullup calibrate
-		if (!digitalRead(calibrate_pin))   // calibrate button pushed?
+		button = alarm_wait();
+		pin_change(rtc_alarm_pin, false);
+		pinMode(rtc_alarm_pin, INPUT); // the RTC holds it low until power_on()
+		if (!button) // the alarm is at the start of that RTC second
 		{
-			power_on();
-			// ensure power is on and calibrate pin is operational
-			calibration_mode();
+			setTime(alarm);
+			sync_last = alarm;
+			sync_interval = time_sync_interval;
+			credit_ms = 0;
+			measure_rtc = 0; // the slices are not measured across an alarm
 		}
-		digitalWrite(calibrate_pin, LOW); // disable pullup calibrate
+		seconds = wake - alarm; // left for the watchdog
+	}
+#endif
+	for (unsigned long n = seconds / sleep_granularity; n-- && !button;)
+	{
 		LowPower.powerDown(SLEEP_4S, ADC_OFF, BOD_OFF);
+		button = !digitalRead(calibrate_pin); // calibrate button pushed?
+		if (!button)
+		{
+			credit_ms += slice_ms;
+			measure_slices++;
+		}
+	}
+	adjustTime(credit_ms / 1000);
+	credit_ms %= 1000;
+	if (button)
+	{
+		sync_last = 0; // asleep for an unknown part of a slice
+		measure_rtc = 0;
 	}
+
+	pin_change(calibrate_pin, false);
 	power_on();
+#ifdef RTC_ALARM
+	if (alarm)
+	{
+		RTC.alarmInterrupt(alarm_number(), false);
+		RTC.alarm(alarm_number());
+	}
+#endif
+	if (button)
+		calibration_mode();
+	digitalWrite(calibrate_pin, LOW); // disable pullup calibrate
+}
+
+/**
+ * Read the time from the RTC when the software clock may have drifted from
+ * it: every time_sync_interval seconds, after an unexpected wake up, and at
+ * every wake up until the watchdog slices are measured. The RTC time
+ * between two reads at least time_measure seconds of slices apart, less the
+ * millis() awake, measures a slice.
+ */
+void time_sync()
+{
+	if (sync_last != 0 && now() - sync_last < sync_interval)
+		return;
+
+	time_t t = RTC.get();
+	if (t == 0)
+		return; // no RTC, try again at the next wake up
+	if (measure_rtc != 0 && (long)measure_slices * sleep_granularity >= time_measure)
+	{
+		long asleep_ms = (long)(t - measure_rtc) * 1000 - (long)(millis() - measure_ms);
+		slice_ms = constrain(asleep_ms / measure_slices, (long)slice_min_ms, (long)slice_max_ms);
+		sync_interval = time_sync_interval;
+		measure_rtc = 0;
+	}
+	if (measure_rtc == 0)
+	{
+		measure_rtc = t;
+		measure_ms = millis();
+		measure_slices = 0;
+	}
+	setTime(t);
+	sync_last = t;
+	credit_ms = 0;
 }
 
 /**
@@ -52,6 +256,7 @@ void power_on()
 	TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA); // re-initialize twowire.
 	digitalWrite(rtc_power_pin, HIGH);		  // power up RTC NVRAM chip
 	delay(1);								  // let hardware stabilize
+	RTC.cache(true);						  // registers in a single burst
 }
 
 /**
@@ -59,6 +264,8 @@ void power_on()
  */
 void power_off()
 {
+	journal_flush();				  // the store to NVRAM while it has power
+	RTC.cache(false);				  // and the changed registers
 	delay(1);						  // let hardware stabilize
 	TWCR = 0;						  // disable twowire
 	digitalWrite(rtc_power_pin, LOW); // power down RTC NVRAM chip
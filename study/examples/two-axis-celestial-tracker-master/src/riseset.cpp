@@ -0,0 +1,312 @@
+/**
+ * @file riseset.cpp
+ * @brief Rise, transit and set times of the objects
+ *
+ * The altitude and the hour angle of the object are sampled every
+ * riseset_step seconds over riseset_window seconds. A sign change of the
+ * altitude minus the horizon brackets a rise or a set, a sign change of the
+ * hour angle from negative to positive brackets a transit. Each bracket is
+ * refined with the Illinois variant of regula falsi, which typically needs
+ * three or four more evaluations to get within riseset_precision seconds.
+ *
+ * A satellite pass takes only minutes, so for a satellite the step is
+ * riseset_step_pass seconds.
+ *
+ * getRise() is all sleep_to_rise() needs. It samples the altitude only and
+ * stops at the first rise, about a third of the evaluations of getRiseSet().
+ * For a satellite it first steps riseset_step_coarse seconds, and only
+ * samples every riseset_step_pass seconds where the satellite may come above
+ * the horizon, see satelliteRise().
+ *
+ * Every evaluation runs the same chain as the pointer (getHorizontal()), so
+ * rise and set match the moment the pointer passes the horizon.
+ */
+
+#include "riseset.h"
+
+#include "astronomy.h"
+
+/**
+ * Value whose root is searched for
+ * @param [in] index number of the object
+ * @param [in] t time in UTC
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] loc_lng_d Longitude units: degrees
+ * @param [in] horizon_d altitude of the horizon in degrees
+ * @param [in] transit true for the hour angle, false for the altitude
+ * @returns hour angle in rads (-pi - pi) or altitude above horizon_d in degrees
+ */
+static double riseSetValue(int index, time_t t, double loc_lat_d, double loc_lng_d,
+						   double horizon_d, bool transit)
+{
+	double sidereal_r = getSiderealAngle(t, loc_lng_d);
+	double object_az_d;
+	double object_al_d;
+
+	if (transit)
+	{
+		double object_ra;
+		double object_dc;
+		double object_ro;
+		double hour_angle_r;
+
+		getObject(index, t, &object_ra, &object_dc, &object_ro);
+		hour_angle_r = sidereal_r - object_ra / 12.0 * pi;
+		if (hour_angle_r > pi)
+			hour_angle_r -= 2 * pi;
+		else if (hour_angle_r < -pi)
+			hour_angle_r += 2 * pi;
+		return hour_angle_r;
+	}
+
+	getHorizontal(index, t, loc_lat_d, sidereal_r, &object_az_d, &object_al_d, false);
+	return object_al_d - horizon_d;
+}
+
+/**
+ * Refine a bracketed root, Illinois method
+ * @param [in] a start of the bracket
+ * @param [in] fa value at a
+ * @param [in] b end of the bracket
+ * @param [in] fb value at b, opposite sign of fa
+ * @returns time of the root
+ */
+static time_t riseSetRefine(int index, double loc_lat_d, double loc_lng_d,
+							double horizon_d, bool transit,
+							time_t a, double fa, time_t b, double fb)
+{
+	int side = 0; // end that was replaced last time
+
+	for (int n = 0; n < riseset_iterations && b - a > riseset_precision; n++)
+	{
+		time_t c = a + (time_t)((b - a) * (fa / (fa - fb)));
+		if (c <= a)
+			c = a + 1;
+		else if (c >= b)
+			c = b - 1;
+
+		double fc = riseSetValue(index, c, loc_lat_d, loc_lng_d, horizon_d, transit);
+		if ((fc < 0) == (fa < 0))
+		{
+			a = c;
+			fa = fc;
+			if (side == -1) // b kept twice, pull it in
+				fb /= 2;
+			side = -1;
+		}
+		else
+		{
+			b = c;
+			fb = fc;
+			if (side == 1) // a kept twice, pull it in
+				fa /= 2;
+			side = 1;
+		}
+	}
+	return a + (b - a) / 2;
+}
+
+#ifdef SATELLITE
+#define rho_polar 0.99664719		 // distance of the poles in earth radii
+#define escape_speed 1.75284e-3		 // sqrt(2 GM) in earth radii^1.5 per second
+#define earth_rotation 7.2921e-5	 // rads per second
+#define satellite_margin (pi / 180.0) // refraction and geocentric latitude
+
+/**
+ * How far the satellite is from coming above the horizon, seen from the
+ * center of the earth: the angle between the satellite and the zenith of
+ * the observer, less the largest angle at which it is above horizon_d at its
+ * distance. Taking the observer as close to the center as the poles and a
+ * margin makes this less than the true value.
+ * @param [in] t time in UTC
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] loc_lng_d Longitude units: degrees
+ * @param [in] horizon_d altitude of the horizon in degrees
+ * @param [out] object_ro distance of the satellite in earth radii
+ * @returns rads, the satellite is below the horizon while this is > 0
+ */
+static double satelliteMargin(time_t t, double loc_lat_d, double loc_lng_d,
+							  double horizon_d, double *object_ro)
+{
+	double object_ra;
+	double object_dc;
+
+	getObject(object_satellite, t, &object_ra, &object_dc, object_ro);
+	double lat_r = loc_lat_d / 180.0 * pi;
+	double dc_r = object_dc / 180.0 * pi;
+	double ha_r = getSiderealAngle(t, loc_lng_d) - object_ra / 12.0 * pi;
+	double zenith = acos(sin(lat_r) * sin(dc_r) + cos(lat_r) * cos(dc_r) * cos(ha_r));
+	double horizon_r = horizon_d / 180.0 * pi - satellite_margin;
+	return zenith - (acos(rho_polar * cos(horizon_r) / *object_ro) - horizon_r);
+}
+
+/**
+ * First rise of the satellite. Even the ISS is above the horizon for only
+ * minutes a few times a day, so a scan of riseset_step_pass seconds through
+ * the window would mostly propagate it below the horizon, up to 1441 times.
+ * The margin of satelliteMargin() changes at most as fast as the satellite
+ * at escape speed plus the rotation of the earth, so steps of
+ * riseset_step_coarse over which the margins at both ends add up to more
+ * than that are skipped. The others are scanned as by riseSetScan(), on the
+ * same samples, so the rise is the same. This assumes the distance changes
+ * little within a step, as for the near circular orbits of bright
+ * satellites.
+ * @param [in] from start of the window in UTC
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] loc_lng_d Longitude units: degrees
+ * @param [in] horizon_d altitude of the horizon in degrees
+ * @returns time of the rise, 0 when there is none in the window
+ */
+static time_t satelliteRise(time_t from, double loc_lat_d, double loc_lng_d,
+							double horizon_d)
+{
+	double ro0;
+	double m0 = satelliteMargin(from, loc_lat_d, loc_lng_d, horizon_d, &ro0);
+
+	for (time_t t0 = from; t0 < from + riseset_window; t0 += riseset_step_coarse)
+	{
+		time_t t1 = t0 + riseset_step_coarse;
+		if (t1 > from + riseset_window)
+			t1 = from + riseset_window;
+
+		double ro1;
+		double m1 = satelliteMargin(t1, loc_lat_d, loc_lng_d, horizon_d, &ro1);
+		double ro = ro0 < ro1 ? ro0 : ro1;
+		double rate = escape_speed / (ro * sqrt(ro)) + earth_rotation;
+
+		if (m0 + m1 <= rate * (t1 - t0))
+		{ // may come above the horizon
+			double al0 = riseSetValue(object_satellite, t0, loc_lat_d, loc_lng_d, horizon_d, false);
+			for (time_t t = t0 + riseset_step_pass; t <= t1; t += riseset_step_pass)
+			{
+				double al1 = riseSetValue(object_satellite, t, loc_lat_d, loc_lng_d, horizon_d, false);
+				if (al0 < 0 && al1 >= 0)
+					return riseSetRefine(object_satellite, loc_lat_d, loc_lng_d, horizon_d, false,
+										 t - riseset_step_pass, al0, t, al1);
+				al0 = al1;
+			}
+		}
+		m0 = m1;
+		ro0 = ro1;
+	}
+	return 0;
+}
+#endif
+
+/**
+ * Scan the window for the first rise, transit and set of an object. Only
+ * looking for the rise skips the hour angle, which is a second evaluation of
+ * the object every step, and stops at the rise.
+ * @param [in] index number of the object
+ * @param [in] from start of the window in UTC
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] loc_lng_d Longitude units: degrees
+ * @param [in] horizon_d altitude of the horizon in degrees
+ * @param [in] rise_only true to look for the rise only
+ * @param [out] rs rise, transit and set, 0 when there is none in the window
+ */
+static void riseSetScan(int index, time_t from, double loc_lat_d, double loc_lng_d,
+						double horizon_d, bool rise_only, riseset *rs)
+{
+	time_t t0 = from;
+	double al0 = riseSetValue(index, t0, loc_lat_d, loc_lng_d, horizon_d, false);
+	double ha0 = 0.0;
+	double ha1 = 0.0;
+
+	if (!rise_only)
+		ha0 = riseSetValue(index, t0, loc_lat_d, loc_lng_d, horizon_d, true);
+
+	rs->rise = 0;
+	rs->transit = 0;
+	rs->set = 0;
+
+	time_t step = riseset_step;
+
+#ifdef SATELLITE
+	if (index == object_satellite) // a pass takes minutes
+		step = riseset_step_pass;
+#endif
+
+	for (time_t t1 = from + step; t1 <= from + riseset_window; t1 += step)
+	{
+		double al1 = riseSetValue(index, t1, loc_lat_d, loc_lng_d, horizon_d, false);
+
+		if (rs->rise == 0 && al0 < 0 && al1 >= 0)
+		{
+			rs->rise = riseSetRefine(index, loc_lat_d, loc_lng_d, horizon_d, false,
+									 t0, al0, t1, al1);
+			if (rise_only)
+				break;
+		}
+
+		if (!rise_only)
+		{
+			ha1 = riseSetValue(index, t1, loc_lat_d, loc_lng_d, horizon_d, true);
+			if (rs->set == 0 && al0 >= 0 && al1 < 0)
+				rs->set = riseSetRefine(index, loc_lat_d, loc_lng_d, horizon_d, false,
+										t0, al0, t1, al1);
+			// the hour angle wraps from pi to -pi, that is not a transit
+			if (rs->transit == 0 && ha0 < 0 && ha1 >= 0 && ha1 - ha0 < pi)
+				rs->transit = riseSetRefine(index, loc_lat_d, loc_lng_d, horizon_d, true,
+											t0, ha0, t1, ha1);
+			if (rs->rise != 0 && rs->transit != 0 && rs->set != 0)
+				break;
+		}
+
+		t0 = t1;
+		al0 = al1;
+		ha0 = ha1;
+	}
+}
+
+/**
+ * Get the first rise, transit and set of an object in the window
+ * @param [in] index number of the object
+ * @param [in] from start of the window in UTC
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] loc_lng_d Longitude units: degrees
+ * @param [in] horizon_d altitude of the horizon in degrees
+ * @param [out] rs rise, transit and set, 0 when there is none in the window
+ */
+void getRiseSet(int index, time_t from, double loc_lat_d, double loc_lng_d,
+				double horizon_d, riseset *rs)
+{
+	riseSetScan(index, from, loc_lat_d, loc_lng_d, horizon_d, false, rs);
+}
+
+/**
+ * Get the first rise of an object in the window, i.e. to sleep until then
+ * @param [in] index number of the object
+ * @param [in] from start of the window in UTC
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] loc_lng_d Longitude units: degrees
+ * @param [in] horizon_d altitude of the horizon in degrees
+ * @returns time of the rise, 0 when there is none in the window
+ */
+time_t getRise(int index, time_t from, double loc_lat_d, double loc_lng_d,
+			   double horizon_d)
+{
+	riseset rs;
+
+#ifdef SATELLITE
+	if (index == object_satellite)
+		return satelliteRise(from, loc_lat_d, loc_lng_d, horizon_d);
+#endif
+	riseSetScan(index, from, loc_lat_d, loc_lng_d, horizon_d, true, &rs);
+	return rs.rise;
+}
+
+/**
+ * Get rise, transit and set of all objects, i.e. to plan the night
+ * @param [in] from start of the window in UTC
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] loc_lng_d Longitude units: degrees
+ * @param [in] horizon_d altitude of the horizon in degrees
+ * @param [out] table max_object + 1 entries, indexed by object
+ */
+void getRiseSetAll(time_t from, double loc_lat_d, double loc_lng_d,
+				   double horizon_d, riseset *table)
+{
+	for (int index = 0; index <= max_object; index++)
+		getRiseSet(index, from, loc_lat_d, loc_lng_d, horizon_d, &table[index]);
+}
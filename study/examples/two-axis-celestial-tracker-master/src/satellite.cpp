@@ -0,0 +1,357 @@
+/**
+ * @file satellite.cpp
+ * @brief SGP4 satellite propagation from Two Line Elements
+ *
+ * This is the near earth part of SGP4 as published in Spacetrack Report #3
+ * (Hoots and Roehrich, 1980) with the WGS-72 constants of that report. Deep
+ * space objects (period over 225 minutes) need SDP4, which is not provided.
+ * Bright satellites, like the ISS, are all near earth objects.
+ *
+ * The position is in the TEME frame, which is close enough to the equator
+ * and equinox of date to directly give the geocentric RA and DC. The distance
+ * is kept, so topocentric() can correct for the huge parallax.
+ *
+ * On the AVR double is a 32 bit float. The epoch is parsed into whole
+ * seconds and a fraction, so it keeps its milliseconds, but the propagation
+ * rounds: built with float on a host, the ISS is up to 0.2 km off the double
+ * result in the first 5 days from epoch and up to 0.5 km after a week. Right
+ * above, at 400 km, that is 0.07 degrees, less than half a step of the
+ * pointer; lower in the sky it is less.
+ *
+ * The elements are stored in EEPROM from satellite_eeprom on.
+ */
+
+#include "satellite.h"
+
+#include <EEPROM.h>
+#include "debug.h"
+#include "astronomy.h"
+
+#define xke 0.0743669161	  // sqrt(GM) in earth radii^1.5 per minute
+#define ck2 5.413080e-4		  // 0.5 * J2
+#define ck4 0.62098875e-6	  // -0.375 * J4
+#define a3ovk2 4.690139e-3	  // -J3 / ck2
+#define earth_radius 6378.135 // km
+#define qoms2t 1.880279e-09	  // ((120 - 78) / earth_radius)^4
+#define s_default 1.01222928  // 1 + 78 / earth_radius
+
+/**
+ * elements and the coefficients derived from them by satelliteInit()
+ */
+static satellite_elements sat;
+static boolean sat_loaded = false;
+static boolean isimp;
+static double aodp, xnodp, eta, cosio, sinio, x3thm1, x1mth2, x7thm1;
+static double c1, c4, c5, d2, d3, d4, t2cof, t3cof, t4cof, t5cof;
+static double xmdot, omgdot, xnodot, xnodcf, omgcof, xmcof, xlcof, aycof;
+static double delmo, sinmo;
+
+/**
+ * Parse a number from fixed TLE columns
+ * @param [in] line TLE line
+ * @param [in] first column, 1 based as in the TLE documentation
+ * @param [in] last column
+ * @param [in] implied prefix, "0." for an implied decimal point
+ */
+static double tleField(const char *line, int first, int last, const char *prefix)
+{
+	char field[16];
+	int n = strlen(prefix);
+
+	strcpy(field, prefix);
+	for (int c = first - 1; c < last && n < 15; c++)
+		if (line[c] != ' ')
+			field[n++] = line[c];
+	field[n] = 0;
+	return atof(field);
+}
+
+/**
+ * Convert a Two Line Element set
+ * @param [in] line1 first line of the TLE
+ * @param [in] line2 second line of the TLE
+ * @param [out] el mean elements
+ * @returns false if the lines are not a TLE
+ */
+bool satelliteTle(const char *line1, const char *line2, satellite_elements *el)
+{
+	tmElements_t tm;
+	long day;
+	double seconds;
+	int year;
+
+	if (line1[0] != '1' || line2[0] != '2' || strlen(line1) < 61 || strlen(line2) < 63)
+		return false;
+
+	// epoch, 2 digit year and day of the year with fraction. The day and the
+	// fraction are parsed apart, as a float keeps only about 2 seconds of the
+	// whole, and the fraction alone to some milliseconds
+	year = tleField(line1, 19, 20, "");
+	year += year < 57 ? 2000 : 1900;
+	day = (long)tleField(line1, 21, 23, "") - 1;
+	seconds = tleField(line1, 25, 32, "0.") * 86400.0;
+	tm.Year = CalendarYrToTm(year);
+	tm.Month = 1;
+	tm.Day = 1;
+	tm.Hour = 0;
+	tm.Minute = 0;
+	tm.Second = 0;
+	el->epoch = makeTime(tm) + day * SECS_PER_DAY + (time_t)seconds;
+	el->epoch_frac = seconds - (time_t)seconds;
+
+	// drag term, sign in column 54, then a mantissa with an implied
+	// decimal point and an exponent, "-28098-4"
+	el->bstar = tleField(line1, 55, 59, "0.") *
+				pow(10.0, tleField(line1, 60, 61, ""));
+	if (line1[53] == '-')
+		el->bstar = -el->bstar;
+
+	el->i = tleField(line2, 9, 16, "") / 180.0 * pi;
+	el->node = tleField(line2, 18, 25, "") / 180.0 * pi;
+	el->e = tleField(line2, 27, 33, "0.");
+	el->argp = tleField(line2, 35, 42, "") / 180.0 * pi;
+	el->M = tleField(line2, 44, 51, "") / 180.0 * pi;
+	el->n = tleField(line2, 53, 63, "") * 2.0 * pi / 1440.0;
+	return true;
+}
+
+/**
+ * Initialize the propagator for a set of elements
+ * @param [in] el mean elements
+ */
+void satelliteInit(const satellite_elements *el)
+{
+	sat = *el;
+	sat_loaded = true;
+
+	// recover the original mean motion and semi major axis
+	cosio = cos(sat.i);
+	sinio = sin(sat.i);
+	double theta2 = cosio * cosio;
+	x3thm1 = 3.0 * theta2 - 1.0;
+	x1mth2 = 1.0 - theta2;
+	x7thm1 = 7.0 * theta2 - 1.0;
+	double betao2 = 1.0 - sat.e * sat.e;
+	double betao = sqrt(betao2);
+	double a1 = pow(xke / sat.n, 2.0 / 3.0);
+	double del1 = 1.5 * ck2 * x3thm1 / (a1 * a1 * betao * betao2);
+	double ao = a1 * (1.0 - del1 * (1.0 / 3.0 + del1 * (1.0 + 134.0 / 81.0 * del1)));
+	double delo = 1.5 * ck2 * x3thm1 / (ao * ao * betao * betao2);
+	xnodp = sat.n / (1.0 + delo);
+	aodp = ao / (1.0 - delo);
+
+	// low perigees use a simplified drag model and an adjusted s
+	double perigee = (aodp * (1.0 - sat.e) - 1.0) * earth_radius;
+	isimp = perigee < 220.0;
+	double s4 = s_default;
+	double qoms24 = qoms2t;
+	if (perigee < 156.0)
+	{
+		s4 = perigee <= 98.0 ? 20.0 : perigee - 78.0;
+		qoms24 = pow((120.0 - s4) / earth_radius, 4);
+		s4 = s4 / earth_radius + 1.0;
+	}
+
+	double pinvsq = 1.0 / (aodp * aodp * betao2 * betao2);
+	double tsi = 1.0 / (aodp - s4);
+	eta = aodp * sat.e * tsi;
+	double etasq = eta * eta;
+	double eeta = sat.e * eta;
+	double psisq = fabs(1.0 - etasq);
+	double coef = qoms24 * pow(tsi, 4);
+	double coef1 = coef / pow(psisq, 3.5);
+	double c2 = coef1 * xnodp * (aodp * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) + 0.75 * ck2 * tsi / psisq * x3thm1 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+	c1 = sat.bstar * c2;
+	double c3 = sat.e > 1.0e-4 ? coef * tsi * a3ovk2 * xnodp * sinio / sat.e : 0.0;
+	c4 = 2.0 * xnodp * coef1 * aodp * betao2 * (eta * (2.0 + 0.5 * etasq) + sat.e * (0.5 + 2.0 * etasq) - 2.0 * ck2 * tsi / (aodp * psisq) * (-3.0 * x3thm1 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) + 0.75 * x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * cos(2.0 * sat.argp)));
+	c5 = 2.0 * coef1 * aodp * betao2 * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+	// secular rates of the mean anomaly, perigee and node
+	double theta4 = theta2 * theta2;
+	double temp1 = 3.0 * ck2 * pinvsq * xnodp;
+	double temp2 = temp1 * ck2 * pinvsq;
+	double temp3 = 1.25 * ck4 * pinvsq * pinvsq * xnodp;
+	xmdot = xnodp + 0.5 * temp1 * betao * x3thm1 + 0.0625 * temp2 * betao * (13.0 - 78.0 * theta2 + 137.0 * theta4);
+	omgdot = -0.5 * temp1 * (1.0 - 5.0 * theta2) + 0.0625 * temp2 * (7.0 - 114.0 * theta2 + 395.0 * theta4) + temp3 * (3.0 - 36.0 * theta2 + 49.0 * theta4);
+	double xhdot1 = -temp1 * cosio;
+	xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * theta2) + 2.0 * temp3 * (3.0 - 7.0 * theta2)) * cosio;
+	omgcof = sat.bstar * c3 * cos(sat.argp);
+	xmcof = sat.e > 1.0e-4 ? -2.0 / 3.0 * coef * sat.bstar / eeta : 0.0;
+	xnodcf = 3.5 * betao2 * xhdot1 * c1;
+	t2cof = 1.5 * c1;
+	xlcof = 0.125 * a3ovk2 * sinio * (3.0 + 5.0 * cosio) / (1.0 + cosio);
+	aycof = 0.25 * a3ovk2 * sinio;
+	delmo = pow(1.0 + eta * cos(sat.M), 3);
+	sinmo = sin(sat.M);
+
+	if (!isimp)
+	{
+		double c1sq = c1 * c1;
+		d2 = 4.0 * aodp * tsi * c1sq;
+		double temp = d2 * tsi * c1 / 3.0;
+		d3 = (17.0 * aodp + s4) * temp;
+		d4 = 0.5 * temp * aodp * tsi * (221.0 * aodp + 31.0 * s4) * c1;
+		t3cof = d2 + 2.0 * c1sq;
+		t4cof = 0.25 * (3.0 * d3 + c1 * (12.0 * d2 + 10.0 * c1sq));
+		t5cof = 0.2 * (3.0 * d4 + 12.0 * c1 * d3 + 6.0 * d2 * d2 + 15.0 * c1sq * (2.0 * d2 + c1sq));
+	}
+}
+
+/**
+ * Propagate the satellite
+ * @param [in] tsince minutes since the epoch of the elements
+ * @param [out] x TEME position in earth radii
+ * @param [out] y TEME position in earth radii
+ * @param [out] z TEME position in earth radii
+ */
+void satellitePosition(double tsince, double *x, double *y, double *z)
+{
+	// secular gravity and atmospheric drag
+	double xmdf = sat.M + xmdot * tsince;
+	double omgadf = sat.argp + omgdot * tsince;
+	double xnoddf = sat.node + xnodot * tsince;
+	double omega = omgadf;
+	double xmp = xmdf;
+	double tsq = tsince * tsince;
+	double xnode = xnoddf + xnodcf * tsq;
+	double tempa = 1.0 - c1 * tsince;
+	double tempe = sat.bstar * c4 * tsince;
+	double templ = t2cof * tsq;
+
+	if (!isimp)
+	{
+		double delomg = omgcof * tsince;
+		double delm = xmcof * (pow(1.0 + eta * cos(xmdf), 3) - delmo);
+		xmp = xmdf + delomg + delm;
+		omega = omgadf - delomg - delm;
+		double tcube = tsq * tsince;
+		double tfour = tsince * tcube;
+		tempa = tempa - d2 * tsq - d3 * tcube - d4 * tfour;
+		tempe = tempe + sat.bstar * c5 * (sin(xmp) - sinmo);
+		templ = templ + t3cof * tcube + tfour * (t4cof + tsince * t5cof);
+	}
+
+	double a = aodp * tempa * tempa;
+	double e = sat.e - tempe;
+	double xl = xmp + omega + xnode + xnodp * templ;
+
+	// long period periodics
+	double axn = e * cos(omega);
+	double temp = 1.0 / (a * (1.0 - e * e));
+	double ayn = e * sin(omega) + temp * aycof;
+	double xlt = xl + temp * xlcof * axn;
+
+	// solve Kepler's equation
+	double capu = fmod(xlt - xnode, 2.0 * pi);
+	double epw = capu;
+	double sinepw;
+	double cosepw;
+	for (int n = 0; n < 10; n++)
+	{
+		sinepw = sin(epw);
+		cosepw = cos(epw);
+		double next = (capu - ayn * cosepw + axn * sinepw - epw) /
+						  (1.0 - axn * cosepw - ayn * sinepw) +
+					  epw;
+		if (fabs(next - epw) <= 1.0e-6)
+		{
+			epw = next;
+			break;
+		}
+		epw = next;
+	}
+	sinepw = sin(epw);
+	cosepw = cos(epw);
+
+	// short period preliminary quantities
+	double ecose = axn * cosepw + ayn * sinepw;
+	double esine = axn * sinepw - ayn * cosepw;
+	double elsq = axn * axn + ayn * ayn;
+	double pl = a * (1.0 - elsq);
+	double r = a * (1.0 - ecose);
+	double betal = sqrt(1.0 - elsq);
+	double temp3 = 1.0 / (1.0 + betal);
+	double cosu = a / r * (cosepw - axn + ayn * esine * temp3);
+	double sinu = a / r * (sinepw - ayn - axn * esine * temp3);
+	double u = atan2(sinu, cosu);
+	double sin2u = 2.0 * sinu * cosu;
+	double cos2u = 2.0 * cosu * cosu - 1.0;
+	double temp1 = ck2 / pl;
+	double temp2 = temp1 / pl;
+
+	// update for short periodics
+	double rk = r * (1.0 - 1.5 * temp2 * betal * x3thm1) + 0.5 * temp1 * x1mth2 * cos2u;
+	double uk = u - 0.25 * temp2 * x7thm1 * sin2u;
+	double xnodek = xnode + 1.5 * temp2 * cosio * sin2u;
+	double xinck = sat.i + 1.5 * temp2 * cosio * sinio * cos2u;
+
+	// orientation vectors
+	double sinuk = sin(uk);
+	double cosuk = cos(uk);
+	double sinik = sin(xinck);
+	double cosik = cos(xinck);
+	double sinnok = sin(xnodek);
+	double cosnok = cos(xnodek);
+
+	*x = rk * (-sinnok * cosik * sinuk + cosnok * cosuk);
+	*y = rk * (cosnok * cosik * sinuk + sinnok * cosuk);
+	*z = rk * (sinik * sinuk);
+}
+
+/**
+ * Geocentric RA and DC of the satellite, elements are read from EEPROM
+ * @param [in] now current time in UTC
+ * @param [out] object_ra Right Ascention in hours
+ * @param [out] object_dc Declination in degrees
+ * @param [out] object_ro distance in earth radii
+ */
+void getSatellite(time_t now, double *object_ra, double *object_dc, double *object_ro)
+{
+	double x, y, z;
+
+	if (!sat_loaded)
+	{
+		satellite_elements el;
+		EEPROM.get(satellite_eeprom, el);
+		if (!(el.n > 0.0)) // no elements stored, never rises (in the north)
+		{
+			*object_ra = 0.0;
+			*object_dc = -90.0;
+			*object_ro = 1.0e6;
+			return;
+		}
+		satelliteInit(&el);
+	}
+
+	satellitePosition(((double)(long)(now - sat.epoch) - sat.epoch_frac) / 60.0, &x, &y, &z);
+
+	*object_ra = atan2(y, x) * 12.0 / pi;
+	if (*object_ra < 0.0)
+		*object_ra += 24.0;
+	*object_ro = sqrt(x * x + y * y + z * z);
+	*object_dc = asin(z / *object_ro) * 180.0 / pi;
+}
+
+#ifdef SERIAL_BPS
+/**
+ * Read a TLE from Serial and store it in EEPROM. The two lines have to be
+ * sent within a few seconds after start up.
+ */
+void satelliteSerial()
+{
+	char line1[72];
+	char line2[72];
+	satellite_elements el;
+
+	Serial.setTimeout(5000);
+	line1[Serial.readBytesUntil('\n', line1, sizeof(line1) - 1)] = 0;
+	line2[Serial.readBytesUntil('\n', line2, sizeof(line2) - 1)] = 0;
+	if (satelliteTle(line1, line2, &el))
+	{
+		EEPROM.put(satellite_eeprom, el);
+		satelliteInit(&el);
+		clearHorizontalCache();
+		Serial.println("tle");
+	}
+}
+#endif
@@ -0,0 +1,325 @@
+/**
+ * @file skygrid.cpp
+ * @brief Star catalog with an equal area sky grid index
+ *
+ * The sky is divided in skygrid_bands declination bands of equal area, so
+ * the band borders are equally spaced in sin(declination). Every band is
+ * divided in skygrid_ra_cells equal right ascension cells, which makes all
+ * cells equal in area, much like HEALPix does with its rings. The catalog
+ * is sorted on cell number, so all stars in a cell are found with a binary
+ * search and a short walk.
+ *
+ * A cone search only visits the cells overlapping the cone. The above
+ * horizon query is a cone search around the zenith, which avoids running
+ * transform() for every star in the catalog. The searches take the catalog
+ * as a parameter, so tools/skybench.cpp can run them on large catalogs on a
+ * host; skyBrightestNear() and skyAboveHorizon() search the table below.
+ *
+ * On the device the grid is kept small, as the catalog is small and both
+ * the table and the code live in flash. The grid dimensions in skygrid.h may
+ * be raised for larger catalogs, the cell numbers in the table need to be
+ * recomputed with skyCell() in that case.
+ */
+
+#include "skygrid.h"
+
+#include "astronomy.h"
+
+/**
+ * The star catalog, sorted on sky grid cell. If adding to the list, update
+ * max_object in astronomy.h
+ *
+ * Use https://www.astrouw.edu.pl/~jskowron/ra-dec/?q=03%3A47%3A29.1+24%3A6%3A18
+ * as a converter and double check with it's link to wikisky.org
+ *
+ * Even better, use http://server1.sky-map.org/search?star=alcyone to
+ * directly find coordinates.
+ */
+static const star stars[] PROGMEM = {
+	{14.261, 19.182, -1, 9, 21}, // Arcturis
+	{3.7914, 24.105, 29, 14, 24}, // Alcyone
+	{7.577, 31.888, 16, 13, 25},  // Castor
+	{18.616, 38.784, 0, 10, 28},  // Vega
+	{5.278, 45.998, 1, 12, 31},   // Capella (rotates within the northern half of the azimuthal grid)
+	{11.062, 61.751, 18, 11, 32}, // Dubhe (rotates within the northern half of the azimuthal grid)
+};
+
+#define star_count (int)(sizeof(stars) / sizeof(stars[0]))
+
+/**
+ * callback for every star within the cone of a search
+ */
+typedef void (*sky_visitor)(int n, const star *s, double cos_distance);
+
+/**
+ * state of skyCatalogBrightestNear()
+ */
+static int best_n;
+static int8_t best_mag10;
+static double best_cos_distance;
+
+/**
+ * state of skyCatalogAboveHorizon()
+ */
+static uint8_t *found_objects;
+static int found_max;
+static int found_count;
+
+/**
+ * Get the declination band
+ * @param [in] dc_d declination in degrees
+ * @returns band, 0 is the southern most band
+ */
+static int skyBand(double dc_d)
+{
+	int band = (sin(dc_d / 180.0 * pi) + 1.0) * skygrid_bands / 2.0;
+	if (band >= skygrid_bands)
+		band = skygrid_bands - 1;
+	return band;
+}
+
+/**
+ * Get the sky grid cell of a position
+ * @param [in] ra_h Right Ascention in hours
+ * @param [in] dc_d Declination in degrees
+ * @returns cell number
+ */
+int skyCell(double ra_h, double dc_d)
+{
+	int ra_cell = ra_h * skygrid_ra_cells / 24.0;
+	if (ra_cell >= skygrid_ra_cells)
+		ra_cell = skygrid_ra_cells - 1;
+	return skyBand(dc_d) * skygrid_ra_cells + ra_cell;
+}
+
+/**
+ * Find the first catalog entry in a cell
+ * @param [in] catalog stars sorted on cell, in PROGMEM on the device
+ * @param [in] count number of stars
+ * @param [in] cell sky grid cell
+ * @returns catalog position, count if beyond the last cell in use
+ */
+static int skyFirstInCell(const star *catalog, int count, int cell)
+{
+	int lo = 0;
+	int hi = count;
+
+	while (lo < hi)
+	{
+		int mid = lo + (hi - lo) / 2;
+		if (pgm_read_byte(&catalog[mid].cell) < cell)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/**
+ * Visit all stars within a cone
+ * @param [in] catalog stars sorted on cell, in PROGMEM on the device
+ * @param [in] count number of stars
+ * @param [in] ra_h Right Ascention of the center in hours
+ * @param [in] dc_d Declination of the center in degrees
+ * @param [in] radius_d radius of the cone in degrees
+ * @param [in] visit called for every star in the cone
+ */
+static void skySearch(const star *catalog, int count, double ra_h, double dc_d,
+					  double radius_d, sky_visitor visit)
+{
+	double ra_r = ra_h / 12.0 * pi;
+	double dc_r = dc_d / 180.0 * pi;
+	double radius_r = radius_d / 180.0 * pi;
+	double sin_dc = sin(dc_r);
+	double cos_dc = cos(dc_r);
+	double cos_radius = cos(radius_r);
+	int cell_lo = 0;
+	int cell_hi = skygrid_ra_cells - 1;
+	star s;
+
+	// declination bands touched by the cone, clipped at the poles
+	int band_lo = skyBand(dc_d - radius_d < -90.0 ? -90.0 : dc_d - radius_d);
+	int band_hi = skyBand(dc_d + radius_d > 90.0 ? 90.0 : dc_d + radius_d);
+
+	// right ascension cells touched by the cone. A cone covering a pole
+	// covers all right ascensions
+	if (fabs(dc_d) + radius_d < 90.0)
+	{
+		double half_h = asin(sin(radius_r) / cos_dc) * 12.0 / pi;
+		int lo = floor((ra_h - half_h) * skygrid_ra_cells / 24.0);
+		int hi = floor((ra_h + half_h) * skygrid_ra_cells / 24.0);
+		if (hi - lo < skygrid_ra_cells)
+		{
+			cell_lo = lo;
+			cell_hi = hi;
+		}
+	}
+
+	for (int band = band_lo; band <= band_hi; band++)
+	{
+		for (int ra_cell = cell_lo; ra_cell <= cell_hi; ra_cell++)
+		{
+			int cell = band * skygrid_ra_cells +
+					   (ra_cell + skygrid_ra_cells) % skygrid_ra_cells;
+
+			for (int n = skyFirstInCell(catalog, count, cell); n < count; n++)
+			{
+				memcpy_P(&s, &catalog[n], sizeof(star));
+				if (s.cell != cell)
+					break;
+
+				// cosine of the angular distance to the center
+				double star_dc_r = s.dc_d / 180.0 * pi;
+				double cos_distance = sin_dc * sin(star_dc_r) +
+									  cos_dc * cos(star_dc_r) * cos(s.ra_h / 12.0 * pi - ra_r);
+				if (cos_distance >= cos_radius)
+					visit(n, &s, cos_distance);
+			}
+		}
+	}
+}
+
+/**
+ * Get the Right Ascention and Declination of a catalog star
+ * @param [in] index object index of the star
+ * @param [out] object_ra Right Ascention in hours
+ * @param [out] object_dc Declination in degrees
+ */
+void getStar(int index, double *object_ra, double *object_dc)
+{
+	star s;
+
+	for (int n = 0; n < star_count; n++)
+	{
+		memcpy_P(&s, &stars[n], sizeof(star));
+		if (s.index == index)
+		{
+			*object_ra = s.ra_h;
+			*object_dc = s.dc_d;
+			return;
+		}
+	}
+}
+
+/**
+ * Keep the brightest star, the nearest one if equally bright
+ */
+static void skyVisitBrightest(int n, const star *s, double cos_distance)
+{
+	if (best_n == skygrid_none || s->mag10 < best_mag10 ||
+		(s->mag10 == best_mag10 && cos_distance > best_cos_distance))
+	{
+		best_n = n;
+		best_mag10 = s->mag10;
+		best_cos_distance = cos_distance;
+	}
+}
+
+/**
+ * Find the brightest star near a direction in a catalog
+ * @param [in] catalog stars sorted on cell, in PROGMEM on the device
+ * @param [in] count number of stars
+ * @param [in] ra_h Right Ascention in hours
+ * @param [in] dc_d Declination in degrees
+ * @param [in] radius_d search radius in degrees
+ * @returns catalog position of the star, skygrid_none if there is none
+ */
+int skyCatalogBrightestNear(const star *catalog, int count,
+							double ra_h, double dc_d, double radius_d)
+{
+	best_n = skygrid_none;
+	skySearch(catalog, count, ra_h, dc_d, radius_d, skyVisitBrightest);
+	return best_n;
+}
+
+/**
+ * Find the brightest catalog star near a direction
+ * @param [in] ra_h Right Ascention in hours
+ * @param [in] dc_d Declination in degrees
+ * @param [in] radius_d search radius in degrees
+ * @returns object index of the star, skygrid_none if there is none
+ */
+int skyBrightestNear(double ra_h, double dc_d, double radius_d)
+{
+	int n = skyCatalogBrightestNear(stars, star_count, ra_h, dc_d, radius_d);
+	return n == skygrid_none ? skygrid_none : pgm_read_byte(&stars[n].index);
+}
+
+/**
+ * Collect a star above the horizon
+ */
+static void skyVisitAbove(int n, const star *s, double cos_distance)
+{
+	if (found_count < found_max)
+		found_objects[found_count] = s->index;
+	found_count++;
+}
+
+/**
+ * Count the stars of a catalog above an altitude. The zenith is at the local
+ * sidereal time and the latitude of the observer, so this is a cone search
+ * around the zenith.
+ * @param [in] catalog stars sorted on cell, in PROGMEM on the device
+ * @param [in] count number of stars
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] sidereal_r Sidereal time units: rads
+ * @param [in] min_al_d lowest altitude in degrees, 0 is the horizon
+ * @returns number of stars above min_al_d
+ */
+int skyCatalogAboveHorizon(const star *catalog, int count,
+						   double loc_lat_d, double sidereal_r, double min_al_d)
+{
+	found_count = 0;
+	skySearch(catalog, count, sidereal_r * 12.0 / pi, loc_lat_d, 90.0 - min_al_d, skyVisitAbove);
+	found_max = 0; // only skyAboveHorizon() lists them
+	return found_count;
+}
+
+/**
+ * List the catalog stars above an altitude
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] sidereal_r Sidereal time units: rads
+ * @param [in] min_al_d lowest altitude in degrees, 0 is the horizon
+ * @param [out] objects object indices of the stars found
+ * @param [in] max_objects size of objects
+ * @returns number of stars above min_al_d, may exceed max_objects
+ */
+int skyAboveHorizon(double loc_lat_d, double sidereal_r, double min_al_d,
+					uint8_t *objects, int max_objects)
+{
+	found_objects = objects;
+	found_max = max_objects;
+	return skyCatalogAboveHorizon(stars, star_count, loc_lat_d, sidereal_r, min_al_d);
+}
+
+#ifdef SERIAL_BPS
+/**
+ * Print the object indices of the catalog stars above the horizon, then the
+ * brightest star within skygrid_near_d of an object, i.e. of where the
+ * pointer is aimed, or skygrid_none
+ * @param [in] now current time in UTC
+ * @param [in] loc_lat_d Latitude units: degrees
+ * @param [in] loc_lng_d Longitude units: degrees
+ * @param [in] index number of the object
+ */
+void skySerial(time_t now, double loc_lat_d, double loc_lng_d, int index)
+{
+	uint8_t objects[star_count];
+	double object_ra;
+	double object_dc;
+	double object_ro;
+
+	int found = skyAboveHorizon(loc_lat_d, getSiderealAngle(now, loc_lng_d), 0.0,
+								objects, star_count);
+	Serial.print("sky");
+	for (int n = 0; n < found; n++)
+	{
+		Serial.print(' ');
+		Serial.print(objects[n]);
+	}
+	Serial.println();
+
+	getObject(index, now, &object_ra, &object_dc, &object_ro);
+	Serial.println(skyBrightestNear(object_ra, object_dc, skygrid_near_d));
+}
+#endif
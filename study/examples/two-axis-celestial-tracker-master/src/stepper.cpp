@@ -8,21 +8,298 @@
  *
  * However, the motors I obtained, were 2048 steps per rotation indeed. Make
  * sure you test the motor for at least 10 revolutions.
+ *
+ * The steps are timed by Timer1, which is therefore not available to
+ * anything else (no analogWrite() on pins 9 and 10).
  */
 
 #include "stepper.h"
 
 #include "ds3231.h"
+#include "store.h"
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+unsigned long step_delay_us = step_delay_fast;
+
+/**
+ * Backlash in steps per axis, from NVRAM, and the direction the gears of an
+ * axis last turned. At start up the direction is not known, clockwise is
+ * assumed.
+ */
+static int step_backlash[2];
+static int step_engaged[2] = {1, 1};
+static boolean step_backlash_loaded = false;
+
+static void step_backlash_load()
+{
+	if (!step_backlash_loaded)
+	{
+		step_backlash[0] = backlash_read(0);
+		step_backlash[1] = backlash_read(1);
+		step_backlash_loaded = true;
+	}
+}
 
-int step_delay_ms = step_delay_fast;
+/**
+ * State of the line that is being stepped by the Timer1 interrupt
+ */
+static volatile int step_line_position[2]; // azimuth and altitude in steps
+static int step_line_dir[2];			   // +1 or -1
+static int step_line_steps[2];			   // absolute steps to go
+static int step_line_major;				   // axis that steps every tick
+static int step_line_ticks;				   // steps of the major axis
+static int step_line_done;				   // ticks taken
+static int step_line_error;				   // Bresenham error term
+static int step_line_ramp;				   // index in the ramp
+static unsigned long step_line_c;		   // ramp interval in timer counts
+static unsigned long step_line_cruise;	   // cruise interval in timer counts
+static volatile boolean step_line_busy = false;
 
 /**
- * Set the stepper delay time in ms
- * @param [in] delay in ms
+ * Motor driver by axis, 0 is azimuth, 1 is altitude
+ */
+static void step_hold(int axis, int position)
+{
+	if (axis == 0)
+		motor_azimuth::hold(position);
+	else
+		motor_altitude::hold(position);
+}
+
+static void step_motor(int axis, int position)
+{
+	if (axis == 0)
+		motor_azimuth::step(position);
+	else
+		motor_altitude::step(position);
+}
+
+static void step_idle(int axis)
+{
+	if (axis == 0)
+		motor_azimuth::idle();
+	else
+		motor_altitude::idle();
+}
+
+/**
+ * Set the motor pins to output
+ */
+void step_begin()
+{
+	motor_azimuth::begin();
+	motor_altitude::begin();
+}
+
+/**
+ * Set the stepper cruise delay time in us
+ * @param [in] delay in us
  */
 void set_step_delay(unsigned long delay)
 {
-	step_delay_ms = delay;
+	step_delay_us = delay;
+}
+
+/**
+ * Interval for the next tick. The ramp index is the number of ticks to the
+ * nearest end of the line, so the line accelerates and decelerates the
+ * same way. Moving the index one up or down is a single step of the
+ * constant acceleration recurrence (D. Austin, Generate stepper-motor
+ * speed profiles in real time, 2005)
+ * c(k) = c(k - 1) * (4k - 1) / (4k + 1)
+ * The interval never drops below the cruise interval.
+ *
+ * @returns interval in timer counts
+ */
+static unsigned int step_interval()
+{
+	int left = step_line_ticks - step_line_done;
+	int k = step_line_done < left ? step_line_done : left;
+
+	if (k > step_line_ramp) // up
+	{
+		step_line_c = (step_line_c * (4ul * k - 1) + 2ul * k) / (4ul * k + 1);
+		step_line_ramp = k;
+	}
+	else if (k < step_line_ramp) // down
+	{
+		step_line_c = (step_line_c * (4ul * k + 5) + 2ul * k + 1) / (4ul * k + 3);
+		step_line_ramp = k;
+	}
+
+	if (step_line_c < step_line_cruise)
+		return step_line_cruise;
+	return step_line_c > 65535ul ? 65535u : step_line_c;
+}
+
+/**
+ * Timer1 compare interrupt. Takes one tick of the line: the major axis
+ * steps, the minor axis steps when the Bresenham error term runs out and
+ * idles on the ticks it does not step, see motor.h. After the last tick the
+ * motors are de-energized and the timer is stopped.
+ */
+ISR(TIMER1_COMPA_vect)
+{
+	int minor = 1 - step_line_major;
+
+	if (step_line_done == step_line_ticks)
+	{
+		motor_azimuth::release();
+		motor_altitude::release();
+		TCCR1B = 0;
+		TIMSK1 &= ~_BV(OCIE1A);
+		step_line_busy = false;
+		return;
+	}
+
+	step_line_position[step_line_major] += step_line_dir[step_line_major];
+	step_motor(step_line_major, step_line_position[step_line_major]);
+
+	step_line_error -= step_line_steps[minor];
+	if (step_line_error < 0)
+	{
+		step_line_error += step_line_ticks;
+		step_line_position[minor] += step_line_dir[minor];
+		step_motor(minor, step_line_position[minor]);
+	}
+	else
+		step_idle(minor); // the gears hold, save power
+
+	step_line_done++;
+	OCR1A = step_interval() - 1;
+}
+
+/**
+ * Move both axes along a straight line, so they start and finish
+ * together. The axis with the most steps (major) steps every tick, the
+ * other one (minor) is spread evenly over the move with Bresenham's error
+ * term.
+ *
+ * The ticks are timed by Timer1 (see the interrupt above) with a constant
+ * acceleration from standstill up to the cruise rate set by
+ * set_step_delay() and back. The acceleration satisfies the limit of both
+ * axes: the minor axis only moves steps / ticks of the major axis rate, so
+ * its limit is scaled up by the inverse of that.
+ *
+ * In between ticks the processor idles (SLEEP_MODE_IDLE). It wakes up for
+ * the step interrupt and for the millis() interrupt every ms, which is more
+ * often than a step, so every new position is journaled.
+ *
+ * @param [in,out] position azimuth and altitude in steps
+ * @param [in] delta azimuth and altitude steps to go
+ * @param [in] calibrating boolean, journal the position if false
+ */
+static void step_line(int position[2], const int delta[2], bool calibrating)
+{
+	static const unsigned long accel[2] = {step_accel_azimuth, step_accel_altitude};
+	double a;
+	int minor;
+	int saved[2];
+
+	if (delta[0] == 0 && delta[1] == 0)
+		return;
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		step_line_position[axis] = position[axis];
+		step_line_dir[axis] = delta[axis] > 0 ? 1 : -1;
+		step_line_steps[axis] = abs(delta[axis]);
+		saved[axis] = position[axis];
+	}
+	step_line_major = step_line_steps[0] >= step_line_steps[1] ? 0 : 1;
+	minor = 1 - step_line_major;
+	step_line_ticks = step_line_steps[step_line_major];
+	step_line_error = step_line_ticks / 2;
+	step_line_done = 0;
+
+	// acceleration of the ticks, limited by both axes
+	a = accel[step_line_major];
+	if (step_line_steps[minor] != 0 && (double)accel[minor] * step_line_ticks / step_line_steps[minor] < a)
+		a = (double)accel[minor] * step_line_ticks / step_line_steps[minor];
+
+	// first interval, with Austin's correction for the first step
+	step_line_c = 0.676 * (F_CPU / 64) * sqrt(2.0 / a);
+	step_line_ramp = 0;
+	step_line_cruise = step_delay_us * (F_CPU / 64000ul) / 1000;
+
+	// ensure last pos
+	step_hold(step_line_major, position[step_line_major]);
+	if (step_line_steps[minor] != 0)
+		step_hold(minor, position[minor]);
+
+	// Timer1 in CTC mode, F_CPU / 64
+	step_line_busy = true;
+	TCCR1A = 0;
+	TCNT1 = 0;
+	OCR1A = step_interval() - 1;
+	TIFR1 = _BV(OCF1A);
+	TIMSK1 |= _BV(OCIE1A);
+	TCCR1B = _BV(WGM12) | _BV(CS11) | _BV(CS10);
+
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	for (;;)
+	{
+		cli();
+		if (!step_line_busy)
+		{
+			sei();
+			break;
+		}
+		sleep_enable();
+		sei(); // the next instruction is executed before any interrupt
+		sleep_cpu();
+		sleep_disable();
+
+		for (int axis = 0; axis < 2; axis++)
+		{
+			cli();
+			position[axis] = step_line_position[axis];
+			sei();
+			if (position[axis] != saved[axis] && !calibrating)
+				journal_write(axis, position[axis]); // save
+			saved[axis] = position[axis];
+		}
+	}
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		position[axis] = step_line_position[axis];
+		if (position[axis] != saved[axis] && !calibrating)
+			journal_write(axis, position[axis]); // save
+	}
+}
+
+/**
+ * Choose the azimuth to step to, out of all turns of the same direction.
+ * The azimuth in steps is also the wrap of the cable to the altitude motor,
+ * which is unwound at 0, and may not exceed wrap_budget either way. The
+ * turn closest to where the pointer comes from is taken, unless it is out of
+ * the budget; only then the pointer unwinds.
+ *
+ * With a wrap_budget of 180 this is a fold to -180 - 180 degrees, which
+ * unwinds every object that crosses the fold. A larger budget lets such an
+ * object (e.g. a circumpolar star) pass.
+ *
+ * @param [in] az_ticks azimuth in steps, any turn
+ * @param [in] from_ticks azimuth in steps the pointer comes from
+ * @returns azimuth in steps, within the budget
+ */
+int step_wrap(int az_ticks, int from_ticks)
+{
+	const int limit = (long)wrap_budget * steps_per_revolution / 360;
+
+	while (az_ticks - from_ticks > steps_per_revolution / 2)
+		az_ticks -= steps_per_revolution;
+	while (az_ticks - from_ticks < -steps_per_revolution / 2)
+		az_ticks += steps_per_revolution;
+
+	if (az_ticks > limit)
+		az_ticks -= steps_per_revolution; // unwind
+	else if (az_ticks < -limit)
+		az_ticks += steps_per_revolution;
+	return az_ticks;
 }
 
 /**
@@ -31,28 +308,40 @@ void set_step_delay(unsigned long delay)
  * No shortest path calculation is used. This is delibarate!!
  * First, every movement is just a few steps, so no need, and it avoids
  * cummulative errors. Second, this allows for cabling to the altitude
- * motor, avoiding slip contacts
+ * motor, avoiding slip contacts. The turn to step to is chosen before,
+ * by step_wrap()
+ *
+ * Both axes move along a straight line (see step_line()), so the pointer
+ * does not first move diagonally and then along one axis only. The same
+ * line is used by calibration, the demo and tracking.
  *
- * Every new position is saved to the NVRAM. This way, even if power is
- * interrupted during a movement, calibration is maintained as good as
- * reasonably possible (within one step).
+ * The positions are those of the motors. When an axis last turned counter
+ * clockwise, its pointer lags the motor by the backlash of the gears. When
+ * an axis reverses, the motor takes the backlash steps extra, so the
+ * pointer arrives exactly at the new position. Steady tracking never
+ * reverses, so it takes no extra steps.
+ *
+ * Every new position is journaled (see ds3231.cpp) and the journal is
+ * flushed to the NVRAM at the end of the move. This way, even if power is
+ * interrupted during a movement, calibration is maintained within
+ * journal_steps steps. When calibrating, only the backlash steps are
+ * journaled, so the pointer keeps its position while the user moves it.
  * 
- * @param [in] new_position_azimuth in steps
- * @param [in] new_position_altitude in steps
+ * @param [in] new_position_azimuth pointer position in steps
+ * @param [in] new_position_altitude pointer position in steps
  * @param [in] calibrating boolean
  *  
  */
 void step_to(int new_position_azimuth, int new_position_altitude, bool calibrating)
 {
-	int step_position_azimuth;
-	int step_delta_azimuth; // how to get there
-	int step_position_altitude;
-	int step_delta_altitude; // how to get there
-
-	unsigned long time_ms; // time to next step
+	int step_position[2];
+	int step_delta[2];		   // how to get there
+	int step_slack[2] = {0, 0}; // backlash steps on a reversal
+	int new_position[2] = {new_position_azimuth, new_position_altitude};
 
-	step_position_azimuth = rtcRead(0); // get current position
-	step_position_altitude = rtcRead(1);
+	step_position[0] = journal_read(0); // get current position
+	step_position[1] = journal_read(1);
+	step_backlash_load();
 
 #ifdef SERIAL_DEBUG
 	Serial.print(now());
@@ -62,140 +351,127 @@ void step_to(int new_position_azimuth, int new_position_altitude, bool calibrati
 	Serial.println(new_position_altitude);
 #endif
 
-	// get the delta, process slop compensation if needed. Slop compensation
-	// is enabled on a counter clockwise rotation and when calibration is
-	// false. slop_steps may be 0, which has the same effect as no slop
-	// compensation at all
-	step_delta_azimuth = new_position_azimuth - step_position_azimuth;
-	if (step_delta_azimuth < 0 && !calibrating)
+	// get the delta of the pointer, add the backlash on a reversal
+	for (int axis = 0; axis < 2; axis++)
 	{
-		step_delta_azimuth -= slop_steps;
-	}
-	step_delta_altitude = new_position_altitude - step_position_altitude;
-	if (step_delta_altitude < 0 && !calibrating)
-	{
-		step_delta_altitude -= slop_steps;
+		int pointer = step_position[axis] + (step_engaged[axis] < 0 ? step_backlash[axis] : 0);
+		int direction;
+
+		step_delta[axis] = new_position[axis] - pointer;
+		direction = step_delta[axis] > 0 ? 1 : step_delta[axis] < 0 ? -1 : 0;
+		if (direction != 0 && direction != step_engaged[axis])
+		{
+			step_slack[axis] = direction * step_backlash[axis];
+			step_engaged[axis] = direction;
+		}
+		step_delta[axis] += step_slack[axis];
 	}
 
 	// handle 'do nothing'. Saves a bit of battery life
-	if (step_delta_azimuth == 0 && step_delta_altitude == 0)
+	if (step_delta[0] == 0 && step_delta[1] == 0)
 		return;
 
-	// sync to the next ms
-	time_ms = millis() + 1;
-	while ((long)(millis() < time_ms) > 0)
-	{
-	};
-
-	if (step_delta_azimuth != 0)
-		step_energize(motor_pin_azimuth, step_position_azimuth & 0x3); // ensure last pos
-	if (step_delta_altitude != 0)
-		step_energize(motor_pin_altitude, step_position_altitude & 0x3); // ensure last pos
-
-	time_ms += step_delay_ms;
-	while ((long)(millis() < time_ms) > 0)
-	{
-	};
-
 #ifdef SERIAL_DEBUG
 	Serial.print(now());
 	Serial.print(", dr:");
-	Serial.print(step_delta_azimuth);
+	Serial.print(step_delta[0]);
 	Serial.print(", di:");
-	Serial.println(step_delta_altitude);
+	Serial.println(step_delta[1]);
 #endif
 
-	// a motor may be energized here, but in that case its delta is non zero
-	// so the stepper loop will be entered and it will be de-energized
-	while (step_delta_azimuth != 0 || step_delta_altitude != 0)
+	if (calibrating)
 	{
-		if (step_delta_azimuth > 0) // clockwise
-		{
-			step_position_azimuth++;
-			step_energize(motor_pin_azimuth, step_position_azimuth & 0x3);
-			if (!calibrating)
-				rtcWrite(0, step_position_azimuth); // save
-			step_delta_azimuth--;
-		}
-		else if (step_delta_azimuth < 0) // counter clockwise
-		{
-			step_position_azimuth--;
-			step_energize(motor_pin_azimuth, step_position_azimuth & 0x3);
-			if (!calibrating)
-				rtcWrite(0, step_position_azimuth); // save
-			if (++step_delta_azimuth == 0 && !calibrating)
-				step_delta_azimuth += slop_steps;
-		}
+		for (int axis = 0; axis < 2; axis++)
+			if (step_slack[axis] != 0)
+				journal_write(axis, step_position[axis] + step_slack[axis]);
+	}
 
-		if (step_delta_altitude > 0) // clockwise
-		{
-			step_position_altitude++;
-			step_energize(motor_pin_altitude, step_position_altitude & 0x3);
-			if (!calibrating)
-				rtcWrite(1, step_position_altitude); // save
-			step_delta_altitude--;
-		}
-		else if (step_delta_altitude < 0) // counter clockwise
-		{
-			step_position_altitude--;
-			step_energize(motor_pin_altitude, step_position_altitude & 0x3);
-			if (!calibrating)
-				rtcWrite(1, step_position_altitude); // save
-			if (++step_delta_altitude == 0 && !calibrating)
-				step_delta_altitude += slop_steps;
-		}
+	step_line(step_position, step_delta, calibrating);
 
-		// wait until
-		time_ms += step_delay_ms;
-		while ((long)(millis() < time_ms) > 0)
-		{
-		};
+	journal_flush(); // the move is done
+}
 
-		// de-energize motor
-		if (step_delta_azimuth == 0)
-			step_energize(motor_pin_azimuth, 99);
-		if (step_delta_altitude == 0)
-			step_energize(motor_pin_altitude, 99);
-	}
+/**
+ * Set the backlash of an axis and store it in NVRAM
+ * @param [in] axis 0 is azimuth, 1 is altitude
+ * @param [in] steps backlash in steps, 0 to backlash_max
+ */
+void set_backlash(int axis, int steps)
+{
+	step_backlash_load();
+	backlash_write(axis, steps);
+	store_flush();
+	step_backlash[axis] = backlash_read(axis);
 }
 
 /**
- * Energize in one of 4 step positions, or remove power
- * @param [in] motor_pin_first first IO pin of the motor
- * @param [in] mode 0-3 is step position, any other is off
+ * @param [in] axis 0 is azimuth, 1 is altitude
+ * @returns backlash of an axis in steps
  */
-void step_energize(int motor_pin_first, int mode)
+int get_backlash(int axis)
 {
-	switch (mode)
+	step_backlash_load();
+	return step_backlash[axis];
+}
+
+#ifdef MOTOR_BENCH
+/**
+ * Cycles per step of a motor driver on pins A0-A3, counted by Timer1 at
+ * F_CPU, including the loop. The pins must be unconnected, see main.h.
+ * @param [in] name of the driver
+ */
+template <class motor>
+static void step_bench_one(const char *name)
+{
+	const int steps = 64;
+	unsigned int cycles;
+
+	motor::begin();
+	motor::hold(0);
+	cli();
+	TCCR1A = 0;
+	TCCR1B = _BV(CS10);
+	TCNT1 = 0;
+	for (int position = 1; position <= steps; position++)
+		motor::step(position);
+	cycles = TCNT1;
+	TCCR1B = 0;
+	sei();
+	motor::release();
+	for (int pin = A0; pin <= A3; pin++)
+		pinMode(pin, INPUT);
+
+	Serial.print(name);
+	Serial.print(": ");
+	Serial.println(cycles / steps);
+}
+
+/**
+ * The four digitalWrite() calls the drivers replace
+ */
+template <uint8_t first_pin>
+struct step_bench_digital
+{
+	static void begin() {}
+	static void hold(int position) { step(position); }
+	static void release() { step(-1); }
+	static void step(int position)
 	{
-	case 0:
-		digitalWrite(motor_pin_first, HIGH);
-		digitalWrite(motor_pin_first + 1, HIGH);
-		digitalWrite(motor_pin_first + 2, LOW);
-		digitalWrite(motor_pin_first + 3, LOW);
-		break;
-	case 1:
-		digitalWrite(motor_pin_first, HIGH);
-		digitalWrite(motor_pin_first + 1, LOW);
-		digitalWrite(motor_pin_first + 2, LOW);
-		digitalWrite(motor_pin_first + 3, HIGH);
-		break;
-	case 2:
-		digitalWrite(motor_pin_first, LOW);
-		digitalWrite(motor_pin_first + 1, LOW);
-		digitalWrite(motor_pin_first + 2, HIGH);
-		digitalWrite(motor_pin_first + 3, HIGH);
-		break;
-	case 3:
-		digitalWrite(motor_pin_first, LOW);
-		digitalWrite(motor_pin_first + 1, HIGH);
-		digitalWrite(motor_pin_first + 2, HIGH);
-		digitalWrite(motor_pin_first + 3, LOW);
-		break;
-	default:
-		digitalWrite(motor_pin_first, LOW);
-		digitalWrite(motor_pin_first + 1, LOW);
-		digitalWrite(motor_pin_first + 2, LOW);
-		digitalWrite(motor_pin_first + 3, LOW);
+		static const uint8_t coils[4] = {0x3, 0x9, 0xc, 0x6};
+		uint8_t pattern = position < 0 ? 0 : coils[position & 0x3];
+		for (uint8_t n = 0; n < 4; n++)
+			digitalWrite(first_pin + n, pattern >> n & 1);
 	}
+};
+
+/**
+ * Print the cycles per step of every motor driver
+ */
+void step_bench()
+{
+	step_bench_one<step_bench_digital<A0> >("digitalWrite");
+	step_bench_one<motor_uln2003<A0, uln2003_full_step> >("ULN2003 full step");
+	step_bench_one<motor_uln2003<A0, uln2003_half_step> >("ULN2003 half step");
+	step_bench_one<motor_step_dir<A0, A1, A2> >("step/dir");
 }
+#endif
@@ -0,0 +1,284 @@
+/**
+ * @file store.cpp
+ * @brief Typed key/value store in the RTC and EEPROM
+ *
+ * All non volatile settings and positions are kept in a RAM shadow of two
+ * blocks, each closed by a CRC:
+ * - motion: azimuth and altitude, which change with every move
+ * - settings: object, location, aging and backlash, which change in
+ *   calibration only
+ *
+ * A DS3232 keeps both blocks in its SRAM, its alarms are free for the
+ * wake up, see RTC_ALARM. A DS3231 has no SRAM. The AVR EEPROM holds its
+ * settings from store_eeprom on, the registers of alarm 1 hold the positions
+ * and the day/date register of alarm 2 (0x0D) the CRC. The CRC always has
+ * bit 7 set, which in 0x0D is the A2M4 mask bit: alarm 2 matches on hours
+ * and minutes only, so its minutes and hours registers remain free for the
+ * wake up. store_alarm() sets them, they are written with the positions in
+ * a single burst.
+ *
+ * The shadow is read once, at the first store_get(), in one burst per block.
+ * As the AVR keeps its RAM while powered down, a wake up never reads the
+ * store again. store_set() only marks the block it changes as dirty,
+ * store_flush() writes the dirty blocks in one burst, on a DS3232 even both
+ * blocks together.
+ *
+ * A block with a bad CRC is read in the layout of the older firmware, so an
+ * update keeps the calibration: the positions in the alarm registers as
+ * minute-hour-day plus 2000, the settings in EEPROM 0-3 behind a '#'.
+ *
+ * The RTC must be powered, see power_on().
+ */
+
+#include "store.h"
+
+#include "DS3232RTC.h"
+#include <EEPROM.h>
+
+#define SRAM 0x14		// first SRAM register of the DS3232
+#define ALARMS 0x07		// alarm registers, 7 bytes
+#define STATUS 0x0f		// control/status register
+#define BB32KHZ 0x40	// status bit of the DS3232 only, reads 0 on a DS3231
+#define FLAGS 0x83		// status flags, writing a one leaves them
+
+#define store_int8 0
+#define store_uint8 1
+#define store_int16 2
+
+#define motion_size 5	// azimuth, altitude, crc
+#define settings_size 6 // object, location, aging, backlash of both motors, crc
+#define store_size (motion_size + settings_size)
+
+/**
+ * Offset in the shadow and type of every key
+ */
+static const uint8_t store_offset[store_keys] = {0, 2, 8, 9, 5, 6, 7};
+static const uint8_t store_type[store_keys] = {store_int16, store_int16, store_uint8, store_uint8,
+											   store_uint8, store_uint8, store_int8};
+
+static uint8_t store_shadow[store_size]; // as in the SRAM of a DS3232
+static uint8_t store_alarm2[2];			 // minutes and hours of alarm 2, DS3231
+static uint8_t store_dirty = 0;			 // bit 0 motion, bit 1 settings
+static boolean store_on_sram = false;
+static boolean store_loaded = false;
+
+/**
+ * CRC-8 with the Dallas/Maxim polynomial, started at 0xff, of which 7 bits
+ * are kept. Bit 7 is always set, so that cleared memory is not valid, see
+ * above for the DS3231.
+ * @param [in] data bytes
+ * @param [in] size number of bytes
+ * @returns crc
+ */
+static uint8_t store_crc(const uint8_t *data, uint8_t size)
+{
+	uint8_t crc = 0xff;
+
+	while (size--)
+	{
+		crc ^= *data++;
+		for (uint8_t n = 0; n < 8; n++)
+			crc = crc & 1 ? (crc >> 1) ^ 0x8c : crc >> 1;
+	}
+	return crc | 0x80;
+}
+
+/**
+ * @param [in] block first byte of a block in the shadow
+ * @param [in] size of the block including the crc
+ * @returns true if the crc matches
+ */
+static boolean store_valid(const uint8_t *block, uint8_t size)
+{
+	return store_crc(block, size - 1) == block[size - 1];
+}
+
+/**
+ * A position as written by the older firmware in three alarm registers
+ * @param [in] mhd minute, hour and day register
+ * @returns position, 0 if the registers do not hold one
+ */
+static int store_legacy(const uint8_t *mhd)
+{
+	if (mhd[0] >= 60 || mhd[1] >= 24 || mhd[2] < 1 || mhd[2] > 31)
+		return 0;
+	return (mhd[2] - 1) * (60 * 24) + mhd[1] * 60 + mhd[0] - 2000;
+}
+
+/**
+ * Only a DS3232 keeps the BB32KHZ bit that is written to the status register.
+ * The status register is not cached, so it is read back from the RTC.
+ * @returns true if the RTC has SRAM
+ */
+static boolean store_probe()
+{
+	uint8_t status = RTC.readRTC(STATUS);
+
+	RTC.writeRTC(STATUS, status | FLAGS | BB32KHZ);
+	boolean sram = RTC.readRTC(STATUS) & BB32KHZ;
+	RTC.writeRTC(STATUS, status | FLAGS);
+	return sram;
+}
+
+/**
+ * Read the shadow, see above. Blocks that are not yet where they belong are
+ * marked dirty, so the next store_flush() moves them.
+ */
+static void store_load()
+{
+	uint8_t *motion = store_shadow;
+	uint8_t *settings = store_shadow + motion_size;
+
+	store_loaded = true;
+	store_on_sram = store_probe();
+	if (store_on_sram)
+		RTC.readRTC(SRAM, store_shadow, store_size);
+
+	if (!store_on_sram || !store_valid(motion, motion_size))
+	{
+		uint8_t alarms[7];
+
+		RTC.readRTC(ALARMS, alarms, sizeof(alarms));
+		memcpy(motion, alarms, motion_size - 1);
+		memcpy(store_alarm2, alarms + 4, 2);
+		motion[motion_size - 1] = alarms[6];
+		if (!store_valid(motion, motion_size))
+		{
+			int azimuth = store_legacy(alarms + 1);
+			int altitude = store_legacy(alarms + 4);
+
+			motion[0] = azimuth;
+			motion[1] = azimuth >> 8;
+			motion[2] = altitude;
+			motion[3] = altitude >> 8;
+			store_dirty |= 1;
+		}
+		if (store_on_sram)
+			store_dirty |= 1; // move it to the SRAM
+	}
+
+	if (!store_on_sram || !store_valid(settings, settings_size))
+	{
+		for (uint8_t n = 0; n < settings_size; n++)
+			settings[n] = EEPROM.read(store_eeprom + n);
+		if (!store_valid(settings, settings_size))
+		{
+			boolean legacy = EEPROM.read(0) == '#';
+
+			memset(settings, 0, settings_size); // no backlash measured yet
+			for (uint8_t n = 0; legacy && n < 3; n++)
+				settings[n] = EEPROM.read(1 + n);
+			store_dirty |= 2;
+		}
+		if (store_on_sram)
+			store_dirty |= 2; // move it to the SRAM
+	}
+}
+
+/**
+ * Get a value
+ * @param [in] key store_azimuth ... store_aging
+ * @returns value
+ */
+int store_get(uint8_t key)
+{
+	if (!store_loaded)
+		store_load();
+
+	const uint8_t *data = store_shadow + store_offset[key];
+	switch (store_type[key])
+	{
+	case store_int8:
+		return (int8_t)data[0];
+	case store_uint8:
+		return data[0];
+	default:
+		return (int16_t)(data[0] | data[1] << 8);
+	}
+}
+
+/**
+ * Set a value in RAM, store_flush() writes it
+ * @param [in] key store_azimuth ... store_aging
+ * @param [in] value
+ */
+void store_set(uint8_t key, int value)
+{
+	if (!store_loaded)
+		store_load();
+
+	uint8_t *data = store_shadow + store_offset[key];
+	uint8_t size = store_type[key] == store_int16 ? 2 : 1;
+	for (uint8_t n = 0; n < size; n++, value >>= 8)
+	{
+		if (data[n] != (uint8_t)value)
+		{
+			data[n] = value;
+			store_dirty |= store_offset[key] < motion_size ? 1 : 2;
+		}
+	}
+}
+
+/**
+ * Write the changed blocks, in a single burst on a DS3232
+ */
+void store_flush()
+{
+	uint8_t *motion = store_shadow;
+	uint8_t *settings = store_shadow + motion_size;
+
+	if (!store_dirty)
+		return;
+	if (store_dirty & 1)
+		motion[motion_size - 1] = store_crc(motion, motion_size - 1);
+	if (store_dirty & 2)
+		settings[settings_size - 1] = store_crc(settings, settings_size - 1);
+
+	if (store_on_sram)
+	{
+		uint8_t first = store_dirty & 1 ? 0 : motion_size;
+		uint8_t last = store_dirty & 2 ? store_size : motion_size;
+		RTC.writeRTC(SRAM + first, store_shadow + first, last - first);
+	}
+	else
+	{
+		if (store_dirty & 1)
+		{
+			uint8_t alarms[7];
+
+			memcpy(alarms, motion, motion_size - 1);
+			memcpy(alarms + 4, store_alarm2, 2);
+			alarms[6] = motion[motion_size - 1];
+			RTC.writeRTC(ALARMS, alarms, sizeof(alarms));
+			RTC.flush(); // past the register cache, with other changed registers
+		}
+		if (store_dirty & 2)
+			for (uint8_t n = 0; n < settings_size; n++)
+				EEPROM.update(store_eeprom + n, settings[n]);
+	}
+	store_dirty = 0;
+}
+
+/**
+ * Set alarm 2 of a DS3231, which the next store_flush() writes with the
+ * positions. It matches the hours and minutes only, see above.
+ * @param [in] minute 0-59
+ * @param [in] hour 0-23
+ */
+void store_alarm(uint8_t minute, uint8_t hour)
+{
+	store_alarm2[0] = minute / 10 << 4 | minute % 10; // BCD
+	store_alarm2[1] = hour / 10 << 4 | hour % 10;
+	store_dirty |= 1;
+}
+
+/**
+ * @returns true if the store is in the SRAM of a DS3232, so the alarms of the
+ * RTC are free
+ */
+boolean store_sram()
+{
+	if (!store_loaded)
+		store_load();
+	return store_on_sram;
+}
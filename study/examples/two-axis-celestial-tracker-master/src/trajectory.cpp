@@ -0,0 +1,219 @@
+/**
+ * @file trajectory.cpp
+ * @brief Compiles the path of the object into step events
+ *
+ * Instead of evaluating the ephemeris at a fixed cadence, the path of the
+ * object is compiled ahead into a short list of events. Every event is the
+ * time a motor has to step and the pointer position at that time. The
+ * processor wakes only when an event is due and steps to its position
+ * without any further math.
+ *
+ * The path is scanned ahead from the last event. The rate of both axes,
+ * the difference of the last two samples, predicts when either axis next
+ * crosses a tick boundary, and the next sample is taken a little past it,
+ * at most trajectory_scan seconds ahead. When the motor ticks change between
+ * two samples, a binary search finds the second at which they change. A
+ * slow object, e.g. near the pole, thus takes a few samples per event
+ * instead of one every trajectory_scan seconds, and a fast one is not
+ * scanned past its next step. Steps less than trajectory_min_interval
+ * seconds after the previous event are merged into one event, so a fast
+ * object never wakes the processor more often than the fixed cadence did.
+ * When nothing moves for trajectory_max_interval seconds an event is added
+ * anyway, so the clock and battery are still checked regularly.
+ *
+ * Compilation stops at the set of the object. The list is compiled again
+ * when it runs empty.
+ */
+
+#include "trajectory.h"
+
+#include "main.h"
+
+static trajectory_event events[trajectory_events];
+static uint8_t event_first = 0; // first pending event
+static uint8_t event_count = 0; // number of pending events
+
+static double compile_lng;			 // longitude of the observer in degrees
+static time_t compile_t;			 // time the compiler has reached
+static int compile_az;				 // azimuth ticks at compile_t
+static int compile_al;				 // altitude ticks at compile_t
+static double compile_az_steps;		 // azimuth steps at compile_t
+static double compile_al_steps;		 // altitude steps at compile_t
+static boolean compile_below = true; // nothing (more) to compile
+
+/**
+ * Pointer ticks of the object at time t, the azimuth in the turn closest to
+ * the last compiled event
+ * @param [out] az_steps azimuth before truncation to ticks
+ * @param [out] al_steps altitude before truncation to ticks
+ * @returns true if the object is above the horizon
+ */
+static boolean trajectory_ticks(time_t t, int *az_ticks, int *al_ticks, double *az_steps, double *al_steps)
+{
+	return get_ticks(t, getSiderealAngle(t, compile_lng), compile_az, az_ticks, al_ticks,
+					 az_steps, al_steps, false) >= riseset_horizon;
+}
+
+/**
+ * Predict the next tick boundary of one axis from two samples
+ * @param [in] from steps at the first sample
+ * @param [in] to steps at the second sample
+ * @param [in] seconds between the samples
+ * @returns seconds from the second sample to a little past the boundary,
+ * at most trajectory_scan
+ */
+static long trajectory_predict(double from, double to, long seconds)
+{
+	double rate = fabs(to - from) / seconds;					 // steps per second
+	double boundary = to > from ? ceil(to) - to : to - floor(to); // ticks truncate
+	if (boundary == 0.0)
+		boundary = 1.0;
+
+	if (rate * trajectory_scan < boundary)
+		return trajectory_scan;
+	return boundary / rate * trajectory_margin + 1;
+}
+
+/**
+ * Find the next event after compile_t and add it to the list
+ * @returns false if the object set
+ */
+static boolean trajectory_next()
+{
+	time_t a = compile_t; // ticks are unchanged at a
+	time_t b;			  // ticks have changed at b
+	int az;
+	int al;
+	double az_a = compile_az_steps;
+	double al_a = compile_al_steps;
+	double az_b;
+	double al_b;
+	boolean above;
+
+	// steps due within the minimal interval are merged
+	b = a + trajectory_min_interval;
+	above = trajectory_ticks(b, &az, &al, &az_b, &al_b);
+	while (above && az == compile_az && al == compile_al &&
+		   b - compile_t < trajectory_max_interval)
+	{
+		long scan = trajectory_predict(az_a, az_b, b - a);
+		long scan_al = trajectory_predict(al_a, al_b, b - a);
+		if (scan_al < scan)
+			scan = scan_al;
+
+		a = b;
+		az_a = az_b;
+		al_a = al_b;
+		b += scan;
+		if (b - compile_t > trajectory_max_interval)
+			b = compile_t + trajectory_max_interval;
+		above = trajectory_ticks(b, &az, &al, &az_b, &al_b);
+	}
+
+	// binary search the exact second of the change, unless it is merged
+	if (a != compile_t && (!above || az != compile_az || al != compile_al))
+	{
+		while (b - a > 1)
+		{
+			int m_az;
+			int m_al;
+			double m_az_steps;
+			double m_al_steps;
+			time_t m = a + (b - a) / 2;
+			boolean m_above = trajectory_ticks(m, &m_az, &m_al, &m_az_steps, &m_al_steps);
+
+			if (m_above && m_az == compile_az && m_al == compile_al)
+				a = m;
+			else
+			{
+				b = m;
+				az = m_az;
+				al = m_al;
+				az_b = m_az_steps;
+				al_b = m_al_steps;
+				above = m_above;
+			}
+		}
+	}
+
+	uint8_t n = (event_first + event_count) % trajectory_events;
+	events[n].wake = b;
+	events[n].az = az;
+	events[n].al = al;
+	event_count++;
+
+	compile_t = b;
+	compile_az = az;
+	compile_al = al;
+	compile_az_steps = az_b;
+	compile_al_steps = al_b;
+	return above;
+}
+
+/**
+ * Fill the event list up to trajectory_events, unless the object sets
+ */
+static void trajectory_fill()
+{
+	while (!compile_below && event_count < trajectory_events)
+		compile_below = !trajectory_next();
+}
+
+/**
+ * Start compiling the path of the object. The pointer is supposed to be at
+ * the object's position at time t.
+ * @param [in] t time in UTC
+ * @param [in] loc_lng_d the longitude of the observer in degrees
+ */
+void trajectory_start(time_t t, double loc_lng_d)
+{
+	trajectory_clear();
+	compile_lng = loc_lng_d;
+	compile_t = t;
+	compile_az = journal_read(0); // the turn the pointer is in
+	compile_below = !trajectory_ticks(t, &compile_az, &compile_al, &compile_az_steps, &compile_al_steps);
+	trajectory_fill();
+}
+
+/**
+ * Forget all events and stop compiling
+ */
+void trajectory_clear()
+{
+	event_first = 0;
+	event_count = 0;
+	compile_below = true;
+}
+
+/**
+ * Take all events due at time t. The list is refilled when it runs empty.
+ * @param [in] t time in UTC
+ * @param [out] az_ticks azimuth of the last event due
+ * @param [out] al_ticks altitude of the last event due
+ * @returns false if no event is due
+ */
+bool trajectory_pop(time_t t, int *az_ticks, int *al_ticks)
+{
+	bool due = false;
+
+	while (event_count > 0 && events[event_first].wake <= t)
+	{
+		*az_ticks = events[event_first].az;
+		*al_ticks = events[event_first].al;
+		event_first = (event_first + 1) % trajectory_events;
+		event_count--;
+		due = true;
+	}
+	if (event_count == 0)
+		trajectory_fill();
+	return due;
+}
+
+/**
+ * Time of the next event
+ * @returns time in UTC, 0 if there are no events
+ */
+time_t trajectory_wake()
+{
+	return event_count > 0 ? events[event_first].wake : 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file agingfit.cpp
+ * @brief Host test of the aging calibration against synthetic drift
+ *
+ * Runs the fit of aging.cpp, the same code the tracker runs, on two cases:
+ * - samples on a known line, which the fit has to give back, also clamped
+ *   to the temperatures of the samples
+ * - a year of an RTC that drifts 2.0 - 0.0035 * (T - 25)^2 ppm, with a
+ *   seasonal and a daily temperature, corrected once a day against a
+ *   reference with +-3 ms noise. The temperature, the sums and the aging
+ *   register are kept as aging_update() and aging_correct() keep them.
+ * The drift per day in the first and the last month is printed, with and
+ * without calibration. The exit status is not 0 if a check fails.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -Iinclude -o agingfit tools/agingfit.cpp src/aging.cpp
+ * ./agingfit
+ * ```
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "aging.h"
+
+/**
+ * drift of the simulated RTC at aging 0
+ * @param [in] T temperature in C
+ * @returns ppm, positive runs fast
+ */
+static double rate0(double T)
+{
+  return 2.0 - 0.0035 * (T - 25.0) * (T - 25.0);
+}
+
+/**
+ * reference noise, uniform in +-3 ms, the same every run
+ */
+static double noise()
+{
+  static unsigned long seed = 1;
+  seed = seed * 1103515245UL + 12345UL;
+  return ((seed >> 16) & 0x7fff) / 32767.0 * 6.0 - 3.0;
+}
+
+/**
+ * the fit gives back samples on a line
+ * @returns true if it does
+ */
+static bool checkLine()
+{
+  aging_state st;
+  bool ok = true;
+
+  memset(&st, 0, sizeof(st));
+  for (int n = 0; n < aging_samples; n++)
+  {
+    st.samples[n].temperature = 40 + 8 * n;                         // 10 to 24 C
+    st.samples[n].rate = 150 + 2 * (st.samples[n].temperature - 40); // 0.01 ppm
+    st.samples[n].hours = 24 + n;
+  }
+  st.count = aging_samples;
+
+  const float at[] = {40, 60, 96, 0, 200};
+  const float expect[] = {150, 190, 262, 150, 262}; // outside clamped
+  for (unsigned n = 0; n < sizeof(at) / sizeof(at[0]); n++)
+  {
+    float fit = aging_fit(&st, at[n]);
+    if (fabs(fit - expect[n]) > 0.01)
+    {
+      printf("line: fit at %.0f is %.2f, expected %.0f\n", at[n], fit, expect[n]);
+      ok = false;
+    }
+  }
+  if (aging_target(&st, 60, 19) != 19 || aging_target(&st, 60, 17) != 19)
+  {
+    printf("line: aging target at 60 is not 19\n");
+    ok = false;
+  }
+  return ok;
+}
+
+/**
+ * simulate a year of the RTC
+ * @param [in] calibrate run the calibration or leave aging at 0
+ * @param [out] first mean drift over the first 30 days, ms per day
+ * @param [out] last mean drift over the last 30 days, ms per day
+ */
+static void simulate(bool calibrate, double *first, double *last)
+{
+  aging_state st;
+  int aging = 0;
+  double error_ms = 0.0;
+  double error_day = 0.0;
+  float temperature_recent = 0.0;
+  int nf = 0;
+  int nl = 0;
+  time_t t0 = 1640995200; // 2022-01-01
+
+  memset(&st, 0, sizeof(st));
+  *first = *last = 0.0;
+  for (long s = 0; s < 365L * 86400L; s += aging_temperature_interval)
+  {
+    time_t t = t0 + s;
+    double d = s / 86400.0;
+    double T = 12.0 + 8.0 * sin(2 * M_PI * (d - 100.0) / 365.0) + 4.0 * sin(2 * M_PI * d);
+    int temperature = lround(T * 4.0); // 0.25 C, as the RTC reads it
+
+    error_ms += (rate0(T) - aging * aging_lsb / 100.0) * 1e-3 * aging_temperature_interval;
+    if (calibrate) // aging_update()
+    {
+      float dt = aging_temperature_interval;
+      if (s == 0)
+        temperature_recent = temperature;
+      else
+        temperature_recent += (temperature - temperature_recent) * dt / (dt + 86400.0);
+      if (s && st.since)
+        aging_sum(&st, dt, temperature, aging);
+      if (s % aging_save_interval == 0)
+        aging = aging_target(&st, temperature_recent, aging);
+    }
+
+    if (s % 86400L == 43200L)
+    {
+      double day = error_ms - error_day;
+      error_day = error_ms;
+      if (d < 30.0)
+      {
+        *first += fabs(day);
+        nf++;
+      }
+      if (d >= 335.0)
+      {
+        *last += fabs(day);
+        nl++;
+      }
+      if (calibrate) // aging_correct()
+      {
+        aging_sample_add(&st, t, lround(error_ms + noise()));
+        aging = aging_target(&st, temperature_recent, aging);
+      }
+    }
+  }
+  *first /= nf;
+  *last /= nl;
+  printf("%s: first 30 days %.1f ms/day, last 30 days %.1f ms/day, aging %d\n",
+         calibrate ? "calibrated" : "uncalibrated", *first, *last, aging);
+}
+
+int main()
+{
+  bool ok = checkLine();
+  double first;
+  double last;
+  double first0;
+  double last0;
+
+  simulate(false, &first0, &last0);
+  simulate(true, &first, &last);
+  if (last > 15.0 || last > last0 / 3.0)
+  {
+    printf("the calibration does not cancel the drift\n");
+    ok = false;
+  }
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
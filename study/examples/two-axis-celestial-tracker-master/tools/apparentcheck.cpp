@@ -0,0 +1,161 @@
+/**
+ * @file apparentcheck.cpp
+ * @brief Host test and timing of the apparent place stages
+ *
+ * Example 23.a of Meeus, Astronomical Algorithms, theta Persei on 2028
+ * November 13.19 TD, through apparentPlace() and apparentAltitude() with the
+ * stages that are switched on at the build, see apparent.h. The stages can
+ * be switched on with -D as well, as below.
+ *
+ * Meeus gives, after the proper motion, which the firmware does not apply,
+ * - J2000 2h44m11.986s +49d13'42.48", proper motion +0.03425s and -0.0895"
+ *   per year over 28.86705 years
+ * - mean place of date 2h46m11.331s +49d20'54.54"
+ * - nutation +15.843" in right ascension and +6.218" in declination
+ *   (dpsi +14.861", deps +2.705")
+ * - aberration +30.045" and +6.697"
+ * - apparent place 2h46m14.390s +49d21'07.45"
+ * With APPARENT_PRECESSION the J2000 place is the input, otherwise the mean
+ * place of date. The expected place adds the corrections of the stages that
+ * are switched on. Refraction is checked with example 16.a, an apparent
+ * altitude of 0.5 degrees is refracted by 28.754'.
+ *
+ * The differences are printed in arc seconds, of right ascension on the sky.
+ * The exit status is not 0 if one exceeds 1" for the place, the accuracy of
+ * the short nutation series, or 4" for refraction, which is how well
+ * Saemundsson's formula agrees with Bennett's in Meeus.
+ *
+ * Also printed is the time per call on the host, for the stages of this
+ * build. Build once per stage for the cost of each; the cycles on the AVR
+ * are not measured here, that takes avr-gcc and a simulator.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -DAPPARENT_PRECESSION -DAPPARENT_NUTATION -DAPPARENT_ABERRATION -DAPPARENT_REFRACTION -Itools/host -Iinclude -Ilib/Time -o apparentcheck tools/apparentcheck.cpp src/apparent.cpp lib/Time/Time.cpp tools/host/host.cpp
+ * ./apparentcheck
+ * ```
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "apparent.h"
+#include "astronomy.h"
+#include "skygrid.h"
+
+#define arcsec_d (1.0 / 3600.0)   // one arc second in degrees
+#define jd_unix 2440587.5         // julian day of the unix epoch
+#define calls 1000000L            // for the timing
+
+/**
+ * @returns degrees of h m s
+ */
+static double hms(double h, double m, double s)
+{
+  return (h + m / 60.0 + s / 3600.0) * 15.0;
+}
+
+/**
+ * @returns degrees of d m s, positive
+ */
+static double dms(double d, double m, double s)
+{
+  return d + m / 60.0 + s / 3600.0;
+}
+
+/**
+ * @param [in] name of the check
+ * @param [in] error in arc seconds
+ * @param [in] limit in arc seconds
+ * @returns true if within the limit
+ */
+static bool report(const char *name, double error, double limit)
+{
+  printf("%-12s %6.3f\" (limit %.0f\")\n", name, error, limit);
+  return fabs(error) <= limit;
+}
+
+/**
+ * @returns ns per call of apparentPlace(), at times one second apart
+ */
+static double time_place(time_t now, double ra_h, double dc_d)
+{
+  volatile double sink = 0.0;
+  clock_t start = clock();
+
+  for (long n = 0; n < calls; n++)
+  {
+    double ra = ra_h;
+    double dc = dc_d;
+    apparentPlace(first_star, now + n, &ra, &dc);
+    sink = sink + ra + dc;
+  }
+  return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / calls;
+}
+
+/**
+ * @returns ns per call of apparentAltitude(), over the sky
+ */
+static double time_altitude()
+{
+  volatile double sink = 0.0;
+  clock_t start = clock();
+
+  for (long n = 0; n < calls; n++)
+    sink = sink + apparentAltitude(n % 9200 / 100.0 - 2.0);
+  return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / calls;
+}
+
+int main()
+{
+  time_t now = (time_t)((2462088.69 - jd_unix) * 86400.0); // 2028-11-13.19
+  double ra_d = hms(2, 46, 11.331); // mean place of date
+  double dc_d = dms(49, 20, 54.54);
+  bool ok = true;
+
+  printf("stages:");
+#ifdef APPARENT_PRECESSION
+  printf(" precession");
+  double years = 28.86705;
+  ra_d = hms(2, 44, 11.986 + 0.03425 * years); // J2000 with the proper motion
+  dc_d = dms(49, 13, 42.48 - 0.0895 * years);
+#endif
+#ifdef APPARENT_NUTATION
+  printf(" nutation");
+#endif
+#ifdef APPARENT_ABERRATION
+  printf(" aberration");
+#endif
+#ifdef APPARENT_REFRACTION
+  printf(" refraction");
+#endif
+  printf("\n");
+
+  double expect_ra = hms(2, 46, 11.331);
+  double expect_dc = dms(49, 20, 54.54);
+#ifdef APPARENT_NUTATION
+  expect_ra += 15.843 * arcsec_d;
+  expect_dc += 6.218 * arcsec_d;
+#endif
+#ifdef APPARENT_ABERRATION
+  expect_ra += 30.045 * arcsec_d;
+  expect_dc += 6.697 * arcsec_d;
+#endif
+
+  double ra_h = ra_d / 15.0;
+  double dc = dc_d;
+  apparentPlace(first_star, now, &ra_h, &dc);
+  double cos_dc = cos(dc / 180.0 * pi);
+  ok &= report("ra", (ra_h * 15.0 - expect_ra) * cos_dc * 3600.0, 1.0);
+  ok &= report("dc", (dc - expect_dc) * 3600.0, 1.0);
+
+#ifdef APPARENT_REFRACTION
+  double true_al = 0.5 - 28.754 / 60.0;
+  ok &= report("refraction", (apparentAltitude(true_al) - 0.5) * 3600.0, 4.0);
+#endif
+
+  printf("apparentPlace()    %6.1f ns\n", time_place(now, ra_d / 15.0, dc_d));
+  printf("apparentAltitude() %6.1f ns\n", time_altitude());
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
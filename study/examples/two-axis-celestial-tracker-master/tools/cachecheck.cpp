@@ -0,0 +1,133 @@
+/**
+ * @file cachecheck.cpp
+ * @brief Host test and timing of the position cache of getHorizontal()
+ *
+ * Every object is followed from Utrecht for 30 days from 2021-10-17 18:00
+ * UTC, with a wake every cadence seconds, the sleep_default of the fixed
+ * cadence. At each wake getHorizontal() runs with and without the cache,
+ * the angle between the two directions may not exceed cache_error. A third
+ * run puts a look-ahead an hour on, as the rise search and the trajectory
+ * do, with the cache off, between the wakes. It has to give exactly the
+ * directions of the run without it.
+ *
+ * Then the time per wake through a 12 hour night, with and without the
+ * cache, on this host; the cycles on the AVR are not measured here, that
+ * takes avr-gcc and a simulator. Build with the APPARENT_ stages, see
+ * apparent.h, for the cost with those.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -Itools/host -Iinclude -Ilib/Time -o cachecheck tools/cachecheck.cpp src/astronomy.cpp src/skygrid.cpp src/orbit.cpp src/fasttrig.cpp src/satellite.cpp src/apparent.cpp lib/Time/Time.cpp tools/host/host.cpp
+ * ./cachecheck
+ * ```
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "astronomy.h"
+
+#define lat 52.09
+#define lng 5.12
+#define start 1634493600L // 2021-10-17 18:00 UTC
+#define span (30 * 86400L)
+#define night 43200L
+#define cadence 40        // seconds between wakes, sleep_default
+#define look_ahead 3600   // seconds
+#define repeats 20        // of the night, for the timing
+
+/**
+ * @returns angle between two directions in arc seconds
+ */
+static double apart(double az1_d, double al1_d, double az2_d, double al2_d)
+{
+  double al1 = al1_d / 180.0 * pi;
+  double al2 = al2_d / 180.0 * pi;
+  double c = sin(al1) * sin(al2) + cos(al1) * cos(al2) * cos((az1_d - az2_d) / 180.0 * pi);
+  return acos(fmin(c, 1.0)) * 180.0 / pi * 3600.0;
+}
+
+/**
+ * follow one object with the cache, without it and with look-aheads
+ * @param [out] differ wakes where the look-ahead changed the direction
+ * @returns largest angle between cached and uncached in arc seconds
+ */
+static double follow(int index, long *differ)
+{
+  long wakes = span / cadence;
+  double *az = (double *)malloc(wakes * sizeof(double));
+  double *al = (double *)malloc(wakes * sizeof(double));
+  double worst = 0.0;
+
+  clearHorizontalCache();
+  for (long n = 0; n < wakes; n++)
+  {
+    time_t t = start + n * cadence;
+    double sidereal_r = getSiderealAngle(t, lng);
+    double exact_az, exact_al;
+    getHorizontal(index, t, lat, sidereal_r, &az[n], &al[n], true);
+    getHorizontal(index, t, lat, sidereal_r, &exact_az, &exact_al, false);
+    worst = fmax(worst, apart(az[n], al[n], exact_az, exact_al));
+  }
+
+  clearHorizontalCache();
+  for (long n = 0; n < wakes; n++)
+  {
+    time_t t = start + n * cadence;
+    double object_az, object_al;
+    getHorizontal(index, t, lat, getSiderealAngle(t, lng), &object_az, &object_al, true);
+    if (object_az != az[n] || object_al != al[n])
+      (*differ)++;
+    getHorizontal(index, t + look_ahead, lat, getSiderealAngle(t + look_ahead, lng),
+                  &object_az, &object_al, false);
+  }
+
+  free(az);
+  free(al);
+  return worst;
+}
+
+/**
+ * @returns us per wake through the night, with or without the cache
+ */
+static double per_wake(bool cached)
+{
+  volatile double sink = 0.0;
+  long wakes = 0;
+  clock_t begin = clock();
+
+  for (int rep = 0; rep < repeats; rep++)
+    for (int index = 0; index <= max_object; index++)
+    {
+      clearHorizontalCache();
+      for (time_t t = start; t < start + night; t += cadence)
+      {
+        double az, al;
+        getHorizontal(index, t, lat, getSiderealAngle(t, lng), &az, &al, cached);
+        sink = sink + az + al;
+        wakes++;
+      }
+    }
+  return (double)(clock() - begin) / CLOCKS_PER_SEC * 1e6 / wakes;
+}
+
+int main()
+{
+  bool ok = true;
+  long differ = 0;
+
+  for (int index = 0; index <= max_object; index++)
+  {
+    double worst = follow(index, &differ);
+    printf("object %2d: %6.1f\" at most from the uncached position\n", index, worst);
+    ok &= worst <= cache_error;
+  }
+  printf("%ld wakes changed by the look-ahead\n", differ);
+  ok &= differ == 0;
+
+  printf("cached   %.3f us per wake\n", per_wake(true));
+  printf("uncached %.3f us per wake\n", per_wake(false));
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file clocksim.cpp
+ * @brief Host simulation of the software clock across watchdog sleeps
+ *
+ * Runs the body of loop() of the firmware, time_sync(), update_pointer(),
+ * aging_update() and sleep(), through a 12 hour night from Utrecht
+ * (2021-10-17 18:00 UTC) for object 12, on a DS3231 woken by the watchdog.
+ * battery_check() is left out, it waits for the ADC.
+ *
+ * The RTC keeps the true time of the simulation, which includes the time
+ * awake. The watchdog runs 7 to 9 % slow: a slice takes 4 s times 1.08 plus
+ * 0.01 times the sine of half the hours into the night, so its length drifts
+ * by 2 % over the night, which the measurement in time_sync() has to follow.
+ *
+ * Printed are the wake ups, the I2C transactions, of which the reads, and
+ * the error of the software clock against the RTC at every wake up, after
+ * time_sync(). The exit status is not 0 if the clock is ever more than 5 s
+ * off, 75" of sidereal motion, well below a motor step.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -Itools/host -Iinclude -Ilib/Time -Ilib/DS3232RTC/src -o clocksim tools/clocksim.cpp src/*.cpp lib/Time/Time.cpp lib/DS3232RTC/src/DS3232RTC.cpp tools/host/host.cpp
+ * ./clocksim
+ * ```
+ */
+
+#include <stdio.h>
+
+#include "main.h"
+#include "host.h"
+
+#define night_start 1634493600L // 2021-10-17 18:00 UTC
+#define night 43200L
+#define object 12
+#define error_limit 5           // seconds
+
+extern double loc_lat, loc_lng;
+
+static double asleep_s; // true time asleep
+static long slices;
+
+/**
+ * @returns true time, asleep plus millis() awake
+ */
+static double true_time()
+{
+  return night_start + asleep_s + host_ms / 1000.0;
+}
+
+/**
+ * the RTC time registers follow the true time
+ */
+static void request()
+{
+  host_rtc_set((time_t)true_time());
+}
+
+/**
+ * a watchdog slice, slow by 7 to 9 %
+ */
+static void slice(period_t period)
+{
+  double hours = (true_time() - night_start) / 3600.0;
+  asleep_s += sleep_granularity * (1.08 + 0.01 * sin(hours / 2.0));
+  slices++;
+}
+
+int main()
+{
+  long wakes = 0;
+  double error_sum = 0.0;
+  double error_max = 0.0;
+
+  host_rtc_sram = false;
+  host_rtc[0x11] = 20; // temperature
+  host_i2c_request = request;
+  host_power_down = slice;
+
+  request();
+  setTime(night_start);
+  power_on();
+  getLocation(0, &loc_lat, &loc_lng);
+  store_set(store_object, object);
+  host_i2c_writes = 0;
+  host_i2c_reads = 0;
+
+  while (true_time() < night_start + night)
+  {
+    time_sync();
+    double error = fabs((double)now() - floor(true_time()));
+    error_sum += error;
+    error_max = fmax(error_max, error);
+    wakes++;
+
+    unsigned long seconds = update_pointer();
+    aging_update(now());
+    sleep(seconds);
+  }
+
+  printf("%ld wake ups, %ld watchdog slices, %ld I2C transactions (%ld reads)\n",
+         wakes, slices, host_i2c_writes + host_i2c_reads, host_i2c_reads);
+  printf("clock error mean %.2f s, at most %.0f s\n", error_sum / wakes, error_max);
+  bool ok = error_max <= error_limit;
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
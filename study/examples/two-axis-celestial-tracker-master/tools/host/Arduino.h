@@ -0,0 +1,142 @@
+/**
+ * @file Arduino.h
+ * @brief The part of the Arduino core the firmware uses, for the host tools
+ *
+ * This is enough to build the whole firmware on a host for the simulations
+ * in tools/, as an ATmega328P. The registers are plain variables, PROGMEM is
+ * ordinary memory and Serial prints nothing. tools/host/host.cpp defines all
+ * of it and emulates the RTC, see host.h for the hooks of a simulation.
+ *
+ * A tool that only links lib/Time defines millis() itself and does not need
+ * host.cpp, see tools/timecheck.cpp.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ARDUINO
+#define ARDUINO 10800
+#endif
+#define ARDUINO_ARCH_AVR
+#define __AVR__
+#define __AVR_ATmega328P__
+#define F_CPU 16000000UL
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+#define _BV(b) (1 << (b))
+#define bit_is_set(r, b) ((r) & _BV(b))
+
+// program memory is ordinary memory
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_float(p) (*(const float *)(p))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define F(s) s
+
+// registers, as far as the firmware uses them
+extern volatile uint8_t ADMUX, ADCSRA, TWCR, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD,
+    PINB, PINC, PIND, TCCR1A, TCCR1B, TIMSK1, TIFR1, PCICR, PCMSK0, PCMSK1, PCMSK2,
+    PCIFR, EIMSK, EICRA, MCUSR, SREG;
+extern volatile uint16_t ADC, OCR1A, TCNT1;
+
+#define REFS0 6
+#define MUX3 3
+#define MUX2 2
+#define MUX1 1
+#define ADSC 6
+#define TWEN 2
+#define TWIE 0
+#define TWEA 6
+#define WGM12 3
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define OCIE1A 1
+#define OCF1A 1
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCINT2 2
+#define PCINT11 3
+#define PCIF0 0
+#define PCIF1 1
+
+#define ISR(vector) extern "C" void vector(void)
+#define EMPTY_INTERRUPT(vector) \
+  extern "C" void vector(void) {}
+
+#define digitalPinToPCICR(p) (((p) >= 0 && (p) <= 21) ? (&PCICR) : ((volatile uint8_t *)0))
+#define digitalPinToPCICRbit(p) (((p) <= 7) ? 2 : (((p) <= 13) ? 0 : 1))
+#define digitalPinToPCMSK(p) (((p) <= 7) ? (&PCMSK2) : (((p) <= 13) ? (&PCMSK0) : (((p) <= 21) ? (&PCMSK1) : ((volatile uint8_t *)0))))
+#define digitalPinToPCMSKbit(p) (((p) <= 7) ? (p) : (((p) <= 13) ? ((p) - 8) : ((p) - 14)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+inline void cli() {}
+inline void sei() {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+template <class T>
+T constrain(T x, T low, T high)
+{
+  return x < low ? low : x > high ? high : x;
+}
+
+/**
+ * Serial prints nothing and receives nothing
+ */
+struct HardwareSerial
+{
+  void begin(long) {}
+  void end() {}
+  template <class T>
+  size_t print(T) { return 0; }
+  template <class T>
+  size_t print(T, int) { return 0; }
+  template <class T>
+  size_t println(T) { return 0; }
+  template <class T>
+  size_t println(T, int) { return 0; }
+  size_t println() { return 0; }
+  int available() { return 0; }
+  int read() { return -1; }
+  long parseInt() { return 0; }
+  float parseFloat() { return 0; }
+  bool find(const char *) { return false; }
+  size_t readBytesUntil(char, char *, size_t) { return 0; }
+  void setTimeout(long) {}
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,36 @@
+/**
+ * @file EEPROM.h
+ * @brief EEPROM for the host tools, 1 kB as on the ATmega328, erased to 0xff
+ */
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+struct EEPROMClass
+{
+  uint8_t memory[1024];
+
+  EEPROMClass() { memset(memory, 0xff, sizeof(memory)); }
+  uint8_t read(int address) { return memory[address]; }
+  void write(int address, uint8_t value) { memory[address] = value; }
+  void update(int address, uint8_t value) { memory[address] = value; }
+  template <class T>
+  T &get(int address, T &value)
+  {
+    memcpy(&value, memory + address, sizeof(T));
+    return value;
+  }
+  template <class T>
+  const T &put(int address, const T &value)
+  {
+    memcpy(memory + address, &value, sizeof(T));
+    return value;
+  }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,24 @@
+/**
+ * @file Wire.h
+ * @brief I2C for the host tools, talks to the RTC emulated in host.cpp
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct TwoWire
+{
+  void begin() {}
+  void beginTransmission(uint8_t address);
+  uint8_t endTransmission(bool stop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t count);
+  int read();
+  size_t write(uint8_t value);
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,4 @@
+/**
+ * @file interrupt.h
+ * @brief empty for the host tools, Arduino.h has what the firmware needs
+ */
@@ -0,0 +1,4 @@
+/**
+ * @file io.h
+ * @brief empty for the host tools, Arduino.h has what the firmware needs
+ */
@@ -0,0 +1,18 @@
+/**
+ * @file sleep.h
+ * @brief avr/sleep.h for the host tools, sleep_cpu() is in host.cpp
+ */
+
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_PWR_DOWN 2
+
+inline void set_sleep_mode(int) {}
+inline void sleep_enable() {}
+inline void sleep_disable() {}
+inline void sleep_bod_disable() {}
+void sleep_cpu();
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ * @file host.cpp
+ * @brief The Arduino core, the libraries and the RTC for the host tools
+ *
+ * See host.h. Link this with lib/Time and the part of src/ and
+ * lib/DS3232RTC a tool needs.
+ */
+
+#include "host.h"
+
+#include <EEPROM.h>
+#include <Wire.h>
+#include <avr/sleep.h>
+
+volatile uint8_t ADMUX, ADCSRA, TWCR, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD,
+    PINB, PINC, PIND, TCCR1A, TCCR1B, TIMSK1, TIFR1, PCICR, PCMSK0, PCMSK1, PCMSK2,
+    PCIFR, EIMSK, EICRA, MCUSR, SREG;
+volatile uint16_t ADC, OCR1A, TCNT1;
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+TwoWire Wire;
+LowPowerClass LowPower;
+
+unsigned long host_ms = 0;
+double host_timer_us = 0.0;
+uint8_t host_pins[20];
+uint8_t host_rtc[256];
+bool host_rtc_sram = true;
+long host_i2c_writes = 0;
+long host_i2c_reads = 0;
+
+void (*host_digital_write)(uint8_t pin, uint8_t value) = NULL;
+int (*host_digital_read)(uint8_t pin) = NULL;
+void (*host_sleep)() = NULL;
+void (*host_power_down)(period_t period) = NULL;
+void (*host_i2c_request)() = NULL;
+
+static int rtc_pointer = -1; // register of the next I2C byte, -1 for none yet
+static double timer_carry_us = 0.0;
+
+extern "C" void TIMER1_COMPA_vect(void) __attribute__((weak)); // src/stepper.cpp
+
+unsigned long millis()
+{
+  return host_ms++;
+}
+
+unsigned long micros()
+{
+  return host_ms * 1000UL;
+}
+
+void delay(unsigned long ms)
+{
+  host_ms += ms;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  host_pins[pin] = value;
+  if (host_digital_write)
+    host_digital_write(pin, value);
+}
+
+int digitalRead(uint8_t pin)
+{
+  return host_digital_read ? host_digital_read(pin) : HIGH;
+}
+
+/**
+ * With Timer1 running the next compare match wakes the processor: its
+ * period passes and the ISR runs. Else a simulation decides in host_sleep.
+ */
+void sleep_cpu()
+{
+  static const int prescale[] = {0, 1, 8, 64, 256, 1024, 0, 0};
+  int clock = prescale[TCCR1B & 7];
+
+  if (clock && TIMER1_COMPA_vect)
+  {
+    double us = (OCR1A + 1.0) * clock * 1e6 / F_CPU;
+    host_timer_us += us;
+    timer_carry_us += us;
+    host_ms += (unsigned long)(timer_carry_us / 1000.0);
+    timer_carry_us = fmod(timer_carry_us, 1000.0);
+    TIMER1_COMPA_vect();
+  }
+  else if (host_sleep)
+    host_sleep();
+}
+
+void LowPowerClass::powerDown(period_t period, adc_t adc, bod_t bod)
+{
+  if (host_power_down)
+    host_power_down(period);
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+  rtc_pointer = -1;
+}
+
+uint8_t TwoWire::endTransmission(bool stop)
+{
+  host_i2c_writes++;
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t count)
+{
+  host_i2c_reads++;
+  if (host_i2c_request)
+    host_i2c_request();
+  return count;
+}
+
+int TwoWire::read()
+{
+  return host_rtc[rtc_pointer++ & 0xff];
+}
+
+/**
+ * The first byte of a transmission sets the register pointer. A DS3231 has
+ * no SRAM from 0x14 on and no BB32kHz bit in the status register.
+ */
+size_t TwoWire::write(uint8_t value)
+{
+  if (rtc_pointer < 0)
+  {
+    rtc_pointer = value;
+    return 1;
+  }
+  int reg = rtc_pointer++ & 0xff;
+  if (!host_rtc_sram && reg == 0x0f)
+    value &= ~0x40;
+  if (host_rtc_sram || reg < 0x13)
+    host_rtc[reg] = value;
+  return 1;
+}
+
+static uint8_t bcd(int value)
+{
+  return (value / 10) << 4 | value % 10;
+}
+
+/**
+ * Set the time registers of the RTC
+ * @param [in] t time in UTC
+ */
+void host_rtc_set(time_t t)
+{
+  tmElements_t tm;
+
+  breakTime(t, tm);
+  host_rtc[0] = bcd(tm.Second);
+  host_rtc[1] = bcd(tm.Minute);
+  host_rtc[2] = bcd(tm.Hour);
+  host_rtc[3] = tm.Wday;
+  host_rtc[4] = bcd(tm.Day);
+  host_rtc[5] = bcd(tm.Month);
+  host_rtc[6] = bcd(tmYearToY2k(tm.Year));
+}
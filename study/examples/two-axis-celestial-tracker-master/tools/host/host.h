@@ -0,0 +1,36 @@
+/**
+ * @file host.h
+ * @brief State and hooks of the host build of the firmware
+ *
+ * host.cpp runs the firmware on a host for the simulations in tools/. Time
+ * only passes as the simulation lets it: millis() counts one per call, and a
+ * step of the Timer1 ISR adds its period. The RTC is a register file that
+ * answers I2C like a DS3232, or like a DS3231 without its SRAM.
+ *
+ * A simulation sets the hooks it needs; all of them may stay NULL.
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <Arduino.h>
+#include <LowPower.h>
+#include <TimeLib.h>
+
+extern unsigned long host_ms;  // millis()
+extern double host_timer_us;   // time spent in steps of the Timer1 ISR
+extern uint8_t host_pins[20];  // last value written to each pin
+extern uint8_t host_rtc[256];  // RTC registers
+extern bool host_rtc_sram;     // true for a DS3232, false for a DS3231
+extern long host_i2c_writes;   // I2C write transactions
+extern long host_i2c_reads;    // I2C read transactions
+
+extern void (*host_digital_write)(uint8_t pin, uint8_t value); // after the write
+extern int (*host_digital_read)(uint8_t pin);                  // default HIGH
+extern void (*host_sleep)();                                   // sleep_cpu() without Timer1
+extern void (*host_power_down)(period_t period);               // LowPower.powerDown()
+extern void (*host_i2c_request)();                             // before a read
+
+void host_rtc_set(time_t t);
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * @file mpcelements.cpp
+ * @brief Host tool to plan and load comets and asteroids
+ *
+ * Reads MPC one-line orbital elements, either MPCORB.DAT (asteroids) or
+ * CometEls.txt (comets), from stdin. All bodies are propagated to the given
+ * date with orbitBatch(), the same code the tracker runs, and the brightest
+ * are listed on stderr with their RA, DC and estimated magnitude. For each
+ * of those a load line is printed on stdout, which minorSerial() reads when
+ * sent to the tracker right after it has started.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -Iinclude -o mpcelements tools/mpcelements.cpp src/orbit.cpp
+ * ./mpcelements 2024-10-12 4 < CometEls.txt > load.txt
+ * ```
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "orbit.h"
+
+/**
+ * elements plus what is needed for the list, which stays on the host
+ */
+struct body
+{
+  std::string name;
+  bool comet;
+  double H; // absolute magnitude
+  double G; // slope (asteroids) or K (comets)
+};
+
+/**
+ * days from 01-01-1970 for a date in the Gregorian calendar
+ */
+static long daysFromCivil(long y, int m, int d)
+{
+  y -= m <= 2;
+  long era = (y >= 0 ? y : y - 399) / 400;
+  long yoe = y - era * 400;
+  long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+/**
+ * d as used by getPlanet() for a date and fraction of a day
+ */
+static double dayNumber(long y, int m, double day)
+{
+  return daysFromCivil(y, m, 1) - 10957 + day; // 1 on 01-01-2000 0h00
+}
+
+static std::string field(const char *line, int from, int to)
+{
+  std::string s(line + from - 1, to - from + 1);
+  s.erase(0, s.find_first_not_of(' '));
+  s.erase(s.find_last_not_of(" \r\n") + 1);
+  return s;
+}
+
+static double number(const char *line, int from, int to)
+{
+  return atof(field(line, from, to).c_str());
+}
+
+/**
+ * decode a packed MPC date digit: 1-9 and A=10 to V=31
+ */
+static int packed(char c)
+{
+  return isdigit(c) ? c - '0' : c - 'A' + 10;
+}
+
+/**
+ * MPCORB.DAT line, columns as documented by the MPC
+ */
+static bool asteroid(const char *line, orbit_elements *el, body *b)
+{
+  if (strlen(line) < 104 || line[16] != '.')
+    return false;
+
+  std::string epoch = field(line, 21, 25);
+  if (epoch.size() != 5)
+    return false;
+  long y = (packed(epoch[0]) * 100) + (epoch[1] - '0') * 10 + (epoch[2] - '0');
+  double d0 = dayNumber(y, packed(epoch[3]), packed(epoch[4]));
+
+  double M = number(line, 27, 35);
+  double n = number(line, 81, 91);
+  double a = number(line, 93, 103);
+  if (n <= 0.0 || a <= 0.0)
+    return false;
+  if (M > 180.0)
+    M -= 360.0; // nearest perihelion
+
+  el->e = number(line, 71, 79);
+  el->q = a * (1.0 - el->e);
+  el->tp = d0 - M / n;
+  el->peri = number(line, 38, 46) / 180.0 * pi;
+  el->node = number(line, 49, 57) / 180.0 * pi;
+  el->i = number(line, 60, 68) / 180.0 * pi;
+
+  b->comet = false;
+  b->H = number(line, 9, 13);
+  b->G = field(line, 15, 19).empty() ? 0.15 : number(line, 15, 19);
+  size_t length = strlen(line);
+  b->name = length > 167 ? field(line, 167, length < 194 ? length : 194) : field(line, 1, 7);
+  return true;
+}
+
+/**
+ * CometEls.txt line, columns as documented by the MPC
+ */
+static bool comet(const char *line, orbit_elements *el, body *b)
+{
+  if (strlen(line) < 104 || !isdigit(line[14]) || !isdigit(line[16]))
+    return false;
+
+  el->tp = dayNumber(atol(field(line, 15, 18).c_str()), atoi(field(line, 20, 21).c_str()),
+                     number(line, 23, 29));
+  el->q = number(line, 31, 39);
+  el->e = number(line, 42, 49);
+  el->peri = number(line, 52, 59) / 180.0 * pi;
+  el->node = number(line, 62, 69) / 180.0 * pi;
+  el->i = number(line, 72, 79) / 180.0 * pi;
+  if (el->q <= 0.0)
+    return false;
+
+  b->comet = true;
+  b->H = number(line, 92, 95);
+  b->G = number(line, 97, 100);
+  size_t length = strlen(line);
+  b->name = field(line, 103, length < 158 ? length : 158);
+  return true;
+}
+
+/**
+ * estimated visual magnitude, H-G for asteroids, H-K for comets
+ */
+static double magnitude(const body &b, const orbit_position &p, double rs)
+{
+  if (b.comet)
+    return b.H + 5.0 * log10(p.delta) + 2.5 * b.G * log10(p.r);
+
+  double c = (p.r * p.r + p.delta * p.delta - rs * rs) / (2.0 * p.r * p.delta);
+  double t = tan(acos(c < -1.0 ? -1.0 : c > 1.0 ? 1.0 : c) / 2.0);
+  double phi1 = exp(-3.33 * pow(t, 0.63));
+  double phi2 = exp(-1.87 * pow(t, 1.22));
+  return b.H + 5.0 * log10(p.r * p.delta) - 2.5 * log10((1.0 - b.G) * phi1 + b.G * phi2);
+}
+
+int main(int argc, char **argv)
+{
+  int y, m, day;
+  if (argc < 2 || sscanf(argv[1], "%d-%d-%d", &y, &m, &day) != 3)
+  {
+    fprintf(stderr, "usage: %s yyyy-mm-dd [count] < MPCORB.DAT or CometEls.txt\n", argv[0]);
+    return 1;
+  }
+  int count = argc > 2 ? atoi(argv[2]) : 4;
+  double d = dayNumber(y, m, day);
+
+  std::vector<orbit_elements> elements;
+  std::vector<body> bodies;
+  char line[512];
+
+  while (fgets(line, sizeof(line), stdin))
+  {
+    orbit_elements el;
+    body b;
+    if (asteroid(line, &el, &b) || comet(line, &el, &b))
+    {
+      elements.push_back(el);
+      bodies.push_back(b);
+    }
+  }
+
+  std::vector<orbit_position> positions(elements.size());
+  orbitBatch(elements.data(), elements.size(), d, positions.data());
+
+  double Ms, ws, lonsun, rs;
+  orbitSun(d, &Ms, &ws, &lonsun, &rs);
+
+  std::vector<std::pair<double, size_t> > order;
+  for (size_t n = 0; n < bodies.size(); n++)
+    order.push_back(std::make_pair(magnitude(bodies[n], positions[n], rs), n));
+  std::sort(order.begin(), order.end());
+  if ((size_t)count > order.size())
+    count = order.size();
+
+  fprintf(stderr, "%zu bodies, brightest %d on %04d-%02d-%02d\n", order.size(), count, y, m, day);
+  fprintf(stderr, "  mag     ra h    dc d     r AU  delta AU  name\n");
+  for (int n = 0; n < count; n++)
+  {
+    const orbit_position &p = positions[order[n].second];
+    fprintf(stderr, "%5.1f %8.4f %+8.3f %8.3f %8.3f  %s\n", order[n].first,
+           p.ra, p.dc, p.r, p.delta, bodies[order[n].second].name.c_str());
+  }
+  for (int n = 0; n < count; n++)
+  {
+    const orbit_elements &el = elements[order[n].second];
+    printf("m %d %.4f %.7f %.7f %.5f %.5f %.5f\n", n, el.tp, el.q, el.e,
+           el.i / pi * 180.0, el.node / pi * 180.0, el.peri / pi * 180.0);
+  }
+  return 0;
+}
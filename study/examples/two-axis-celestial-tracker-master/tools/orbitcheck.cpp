@@ -0,0 +1,152 @@
+/**
+ * @file orbitcheck.cpp
+ * @brief Host test of orbitHeliocentric() against a two body integration
+ *
+ * For eccentricities from 0.1 to 3, through both edges of near_parabolic,
+ * and perihelion distances of 0.1, 0.3 and 2 AU, the orbit is integrated
+ * numerically from the perihelion 200 days either way: the sun's gravity
+ * only, Runge-Kutta of order 4 in steps of 0.005 days. Its start is the
+ * perihelion of the elements in the J2000 ecliptic, with the speed from the
+ * vis-viva equation. The integration is turned to the equinox of date by
+ * the same precession_per_day as orbitHeliocentric(), which is compared
+ * with it every day.
+ *
+ * Printed is the largest difference per orbit, as an angle seen from the
+ * sun. The exit status is not 0 if it exceeds 10". Elliptic and hyperbolic
+ * orbits agree to well below 0.01", the series of near parabolic orbits is
+ * worst just inside near_parabolic, 8" for q = 0.1 AU 200 days from the
+ * perihelion.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -Iinclude -o orbitcheck tools/orbitcheck.cpp src/orbit.cpp
+ * ./orbitcheck
+ * ```
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "orbit.h"
+
+#define arcsec (180.0 * 3600.0 / pi) // arc seconds per rad
+#define step 0.005                   // days
+#define span 200                     // days either way from the perihelion
+
+/**
+ * position and velocity derivative under the sun's gravity
+ * @param [in] s x, y, z in AU and their rates in AU per day
+ * @param [out] ds rates of s
+ */
+static void gravity(const double *s, double *ds)
+{
+  double r = sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+  double k = gaussian_k * gaussian_k / (r * r * r);
+
+  for (int n = 0; n < 3; n++)
+  {
+    ds[n] = s[n + 3];
+    ds[n + 3] = -k * s[n];
+  }
+}
+
+/**
+ * one Runge-Kutta step
+ * @param [in,out] s state, see gravity()
+ * @param [in] h step in days
+ */
+static void rk4(double *s, double h)
+{
+  double k1[6], k2[6], k3[6], k4[6], t[6];
+
+  gravity(s, k1);
+  for (int n = 0; n < 6; n++)
+    t[n] = s[n] + h / 2 * k1[n];
+  gravity(t, k2);
+  for (int n = 0; n < 6; n++)
+    t[n] = s[n] + h / 2 * k2[n];
+  gravity(t, k3);
+  for (int n = 0; n < 6; n++)
+    t[n] = s[n] + h * k3[n];
+  gravity(t, k4);
+  for (int n = 0; n < 6; n++)
+    s[n] += h / 6 * (k1[n] + 2 * k2[n] + 2 * k3[n] + k4[n]);
+}
+
+/**
+ * unit vector in the orbit plane at an argument of latitude, J2000 ecliptic
+ */
+static void direction(const orbit_elements *el, double u, double *v)
+{
+  double node = el->node; // not the float overloads of cos() and sin()
+  double i = el->i;
+
+  v[0] = cos(node) * cos(u) - sin(node) * sin(u) * cos(i);
+  v[1] = sin(node) * cos(u) + cos(node) * sin(u) * cos(i);
+  v[2] = sin(u) * sin(i);
+}
+
+/**
+ * integrate one orbit from the perihelion and compare
+ * @param [in] el elements
+ * @param [in] direction 1 for forward in time, -1 for back
+ * @returns largest difference in rads seen from the sun
+ */
+static double compare(const orbit_elements *el, int sign)
+{
+  double s[6];
+  double p[3];
+  double q[3];
+  double speed = gaussian_k * sqrt((1.0 + el->e) / el->q); // vis-viva
+  double worst = 0.0;
+
+  direction(el, el->peri, p);
+  direction(el, el->peri + pi / 2, q);
+  for (int n = 0; n < 3; n++)
+  {
+    s[n] = el->q * p[n];
+    s[n + 3] = speed * q[n];
+  }
+
+  for (long n = 1; n <= (long)(span / step); n++)
+  {
+    rk4(s, sign * step);
+    if (n % (long)(1.0 / step))
+      continue;
+
+    double d = el->tp + sign * n * step;
+    double a = precession_per_day * d;
+    double x = s[0] * cos(a) - s[1] * sin(a); // to the equinox of date
+    double y = s[0] * sin(a) + s[1] * cos(a);
+    double z = s[2];
+    double xh, yh, zh;
+    orbitHeliocentric(el, d, &xh, &yh, &zh);
+
+    double r = sqrt(x * x + y * y + z * z);
+    double e = sqrt((xh - x) * (xh - x) + (yh - y) * (yh - y) + (zh - z) * (zh - z)) / r;
+    if (e > worst)
+      worst = e;
+  }
+  return worst;
+}
+
+int main()
+{
+  const float eccentricities[] = {0.1, 0.5, 0.9, 0.99, 0.994, 0.996, 0.999, 1.0,
+                                  1.001, 1.004, 1.006, 1.5, 3.0};
+  const float perihelia[] = {0.1, 0.3, 2.0};
+  double worst = 0.0;
+
+  for (unsigned k = 0; k < sizeof(perihelia) / sizeof(perihelia[0]); k++)
+    for (unsigned n = 0; n < sizeof(eccentricities) / sizeof(eccentricities[0]); n++)
+    {
+      orbit_elements el = {8700.0f, perihelia[k], eccentricities[n], 0.4f, 1.0f, 2.0f};
+      double e = fmax(compare(&el, 1), compare(&el, -1)) * arcsec;
+
+      printf("q %.1f e %.3f: %.2f\"\n", el.q, el.e, e);
+      if (e > worst)
+        worst = e;
+    }
+  printf("at most %.2f\"\n%s\n", worst, worst <= 10.0 ? "ok" : "FAIL");
+  return worst <= 10.0 ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+/**
+ * @file planetcheck.cpp
+ * @brief Host test of the element and perturbation tables of getPlanet()
+ *
+ * getPlanet() takes the orbital elements of the planets and the moon, and
+ * the perturbation terms of the moon, jupiter, saturn and uranus, from
+ * PROGMEM tables. This compares it with the inline code the tables
+ * replaced, which is kept below: a switch over the objects for the
+ * elements and one statement per perturbation term. Both have to give the
+ * same RA, DC and distance of the moon, to the bit, for objects 0 to 8 at
+ * 200000 pseudo random times from 1990 to 2040. The tables keep the terms
+ * in their order and build every argument with the same operations, so any
+ * difference is a typo in a table. The exit status is not 0 if any differ.
+ *
+ * The firmware has to be built with its default switches, FAST_TRIG and the
+ * apparent place stages off, as the inline code uses the float library and
+ * no corrections.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -Itools/host -Iinclude -Ilib/Time -o planetcheck tools/planetcheck.cpp src/astronomy.cpp src/skygrid.cpp src/orbit.cpp src/fasttrig.cpp src/satellite.cpp src/apparent.cpp lib/Time/Time.cpp tools/host/host.cpp
+ * ./planetcheck
+ * ```
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "astronomy.h"
+
+// the inline version, as in astronomy.cpp before the tables
+
+static void inlinePlanet(int object, time_t now, double *object_ra, double *object_dc, double *moon_ro)
+{
+  double d; // days to Dec 31st 0h00 1999 - note, this is NOT same as J2000
+
+  double No; // Longitude of the object's ascending node
+  // double Ns;      // Longitude of the Sun's ascending node
+  double io; // Object's inclination to the ecliptic (Earth's orbit plane)
+  // double is;      // Sun's inclination to ecliptic (plane of the Earth's orbit)
+  double wo;  // Argument of perihelion for the object
+  double ws;  // Argument of perihelion for the Sun
+  double ao;  // Object semi-major axis, or mean distance from Earth (AU, Earth radii for the Moon)
+  double eco; // Object eccentricity (0=circle, 0-1=ellipse, 1=parabola)
+  double Mo;  // Mean Anomaly of the object
+  double Ms;  // Mean Anomaly of the Sun (earth)
+  double Mj;  // Mean anomaly of Jupiter
+  double Ma;  // Mean anomaly of sAturn
+  double Mu;  // Mean anomaly of Uranus
+
+  double lat;     // Object geocentric lat
+  double lon;     // Object geocentric long
+  double Eo;      // Object eccentric anomaly
+  double Eo1;     // Next iteration of the eccentric anomaly
+  double EoDelta; // Temp for iteration
+  double xv, yv;  // Temp vector to compute distance and true anomaly
+  double lonsun;  // Sun's true longitude
+  double rs;      // Sun's distance
+
+  double ddo; // Mean elongation of the object
+  double F;   // Argument of latitude for the object
+  double Lo;  // Mean longitude of the object
+  double Ls;  // Mean Longitude of the Sun  (Ns=0)
+  double vo;  // Object true anomaly
+  double ro;  // Object distance
+
+  double xh, yh, zh; // vector position of object seen from the sun
+  double xg, yg, zg; // h-vector + Sun (=earth) position
+
+  // http://www.stjarnhimlen.se/comp/ppcomp.html#3
+
+  d = (now - 946684800.0) / 86400.0 + 1; // days since 31-12-1999T00:00:00
+
+  // sun, lonsun is also used for planetary positions
+  orbitSun(d, &Ms, &ws, &lonsun, &rs);
+  xg = rs * cos(lonsun); // xg, yg and zg are converted to RA and DE
+  yg = rs * sin(lonsun);
+  zg = 0;
+
+  // Sun's equatorial coordinates, RA and Dec are computed and the end of this fuunction
+  // if not the sun, get the object elements
+  // http://www.stjarnhimlen.se/comp/ppcomp.html#4
+
+  switch (object)
+  {
+  case 1:                                            // Orbital elements of Mercury
+    No = 0.843540316769135 + 5.665111859171E-7 * d;  // 48.3313 + 3.24587E-5 * d;
+    io = 0.122255078114447 + 8.726646259972E-10 * d; //  7.0047 + 5.00E-8 * d;
+    wo = 0.508311436680081 + 1.770531806393E-7 * d;  // 29.1241 + 1.01444E-5 * d;
+    ao = 0.387098;                                   // (AU)
+    eco = 0.205635 + 5.59E-10 * d;
+    Mo = 2.94360599390206 + 7.142471001491E-2 * d; // 168.6562 + 4.0923344368 * d;
+    break;
+
+  case 2:                                             // Orbital elements of Venus
+    No = 1.3383167251 + 4.303807402493E-7 * d;        // 76.6799 + 2.46590E-5 * d;
+    io = 0.0592469467881995 + 4.799655442984E-10 * d; // 3.3946 + 2.75E-8 * d;
+    wo = 0.958028679712207 + 2.415081899155E-7 * d;   // 54.8910 + 1.38374E-5 * d;
+    ao = 0.723330;                                    // (AU)
+    eco = 0.006773 - 1.302E-9 * d;
+    Mo = 0.837848798078382 + 2.796244746150E-2 * d; // 48.0052 + 1.6021302244 * d;
+    break;
+
+  case 3:                                          // Orbital elements of the Moon
+    No = 2.18380482931436 - 9.242183063049E-4 * d; // 125.1228 - 0.0529538083# * d
+    io = 0.0898041713321162;                       // 5.1454
+    wo = 5.55125356008773 + 2.868576423897E-3 * d; // 318.0634 + 0.1643573223# * d
+    ao = 60.2666;                                  // (Earth radii)
+    eco = 0.0549;
+    Mo = 2.01350607288027 + 2.280271437431E-1 * d; // 115.3654 + 13.0649929509 * d
+    break;
+
+  case 4:                                               // Orbital elements of Mars
+    No = 0.864939798727838 + 3.68405843840215E-7 * d;   // 49.5574 + 2.11081E-5 * d;
+    io = 0.0322833551741391 - 3.10668606854991E-10 * d; // 1.8497 - 1.78E-8 * d;
+    wo = 5.00039623223179 + 5.11313402993511E-7 * d;    // 286.5016 + 2.92961E-5 * d;
+    ao = 1.523688;                                      // (AU)
+    eco = 0.093405 + 2.516E-9 * d;
+    Mo = 0.324667892785237 + 9.14588790052766E-3 * d; // 18.6021 + 0.5240207766 * d;
+    break;
+
+  case 5:                                            // Orbital elements of Jupiter
+    No = 1.75325653745689 + 4.832013847316E-7 * d;   // 100.4542 + 2.76854E-5 * d;
+    io = 0.0227416401534861 - 2.717477645355E-9 * d; // 1.3030 - 1.557E-7 * d;
+    wo = 4.78006761278927 + 2.871153885993E-7 * d;   // 273.8777 + 1.64505E-5 * d;
+    ao = 5.20256;                                    // (AU)
+    eco = 0.048498 + 4.469E-9 * d;
+    Mo = 0.347233254684272 + 1.450112046753E-3 * d; // 19.8950 + 0.0830853001 * d;
+    break;
+
+  case 6:                                            // Orbital elements of Saturn
+    No = 1.98380056901132 + 4.170987846416E-7 * d;   // 113.6634 + 2.38980E-5 * d;
+    io = 0.0434342637651309 - 1.886700921406E-9 * d; // 2.4886 - 1.081E-7 * d;
+    wo = 5.92354101618438 + 5.195164504779E-7 * d;   // 339.3939 + 2.97661E-5 * d;
+    ao = 9.55475;                                    // (AU)
+    eco = 0.055546 - 9.499E-9 * d;
+    Mo = 5.53211777016887 + 5.837118978783E-4 * d; // 316.9670 + 0.0334442282 * d;
+    break;
+
+  case 7:                                             // Orbital elements of Uranus
+    No = 1.29155237312206 + 2.439621228438E-7 * d;    // 74.0005 + 1.3978E-5 * d;
+    io = 0.0134966311056722 + 3.316125578789E-10 * d; // 0.7733 + 1.9E-8 * d;
+    wo = 1.68705619892874 + 5.334598858721E-7 * d;    // 96.6612 + 3.0565E-5 * d;
+    ao = 19.18171 - 1.55E-8 * d;                      // (AU)
+    eco = 0.047318 + 7.45E-9 * d;
+    Mo = 2.48867370706497 + 2.046539221501E-4 * d; // 142.5905 + 0.011725806 * d;
+    break;
+
+  case 8:                                            // Orbital elements of Neptune
+    No = 2.30000536025364 + 5.266181952043E-7 * d;   // 131.7806 + 3.0173E-5 * d;
+    io = 0.0308923277602996 - 4.450589592586E-9 * d; // 1.7700 - 2.55E-7 * d;
+    wo = 4.7620627962257 - 1.051909940177E-7 * d;    // 272.8461 - 6.027E-6 * d;
+    ao = 30.05826 + 3.313E-8 * d;                    // (AU)
+    eco = 0.008606 + 2.15E-9 * d;
+    Mo = 4.54216876376693 + 1.046350542911E-4 * d; // 260.2471 + 0.005995147 * d;
+    break;
+  }
+
+  if (object != 0)
+  { // for all objects, except the sun
+
+    {
+      // eccentric anomaly of the object
+      // http://www.stjarnhimlen.se/comp/ppcomp.html#6
+
+      Eo = Mo + eco * sin(Mo) * (1.0 + eco * cos(Mo));
+      EoDelta = 1.0;
+      while (EoDelta < -0.000872664 || EoDelta > 0.000872664)
+      {
+        Eo1 = Eo - (Eo - eco * sin(Eo) - Mo) / (1 - eco * cos(Eo));
+        EoDelta = Eo - Eo1;
+        Eo = Eo1;
+      }
+
+      // objects vector
+      xv = ao * (cos(Eo) - eco);
+      yv = ao * (sqrt(1.0 - eco * eco) * sin(Eo));
+
+      // object true anomaly an distance
+      vo = atan2(yv, xv);
+      ro = sqrt(xv * xv + yv * yv);
+
+      // object geocentric position in 3D space
+      // http://www.stjarnhimlen.se/comp/ppcomp.html#7
+
+      xh = ro * (cos(No) * cos(vo + wo) - sin(No) * sin(vo + wo) * cos(io));
+      yh = ro * (sin(No) * cos(vo + wo) + cos(No) * sin(vo + wo) * cos(io));
+      zh = ro * (sin(vo + wo) * sin(io));
+    }
+
+    // objects geocentric long and lat
+    lon = atan2(yh, xh);
+    lat = atan2(zh, sqrt(xh * xh + yh * yh));
+
+    // No precession corrections
+    // http://www.stjarnhimlen.se/comp/ppcomp.html#8
+    // Pertubations for the moon, jupiter, saturn and uranus
+
+    if (object == 3)
+    { // moon
+
+      // http://www.stjarnhimlen.se/comp/ppcomp.html#9
+
+      // first calculate arguments below, which should be in radians
+      Ls = Ms + ws;      // Mean Longitude of the Sun  (Ns=0)
+      Lo = Mo + wo + No; // Mean longitude of the Moon
+      ddo = Lo - Ls;     // Mean elongation of the Moon
+      F = Lo - No;       // Argument of latitude for the Moon
+
+      // then add the following terms to the longitude
+      lon = lon - 0.022235495 * sin(Mo - 2 * ddo);      // -1.274 (the Evection)
+      lon = lon + 0.011484266 * sin(2 * ddo);           //  0.658 (the Variation)
+      lon = lon - 0.003246312 * sin(Ms);                // -0.186 (the Yearly Equation)
+      lon = lon - 0.001029744 * sin(2 * Mo - 2 * ddo);  // -0.059
+      lon = lon - 0.000994838 * sin(Mo - 2 * ddo + Ms); // -0.057
+      lon = lon + 0.000925025 * sin(Mo + 2 * ddo);      //  0.053
+      lon = lon + 0.000802851 * sin(2 * ddo - Ms);      //  0.046
+      lon = lon + 0.000715585 * sin(Mo - Ms);           //  0.041
+      lon = lon - 0.000610865 * sin(ddo);               // -0.035 (the Parallactic Equation)
+      lon = lon - 0.000541052 * sin(Mo + Ms);           // -0.031
+      lon = lon - 0.000261799 * sin(2 * F - 2 * ddo);   // -0.015
+      lon = lon + 0.000191986 * sin(Mo - 4 * ddo);      //  0.011
+
+      // latitude terms
+      lat = lat - 0.003019420 * sin(F - 2 * ddo);      // -0.173
+      lat = lat - 0.000959931 * sin(Mo - F - 2 * ddo); // -0.055
+      lat = lat - 0.000802851 * sin(Mo + F - 2 * ddo); // -0.046
+      lat = lat + 0.000575959 * sin(F + 2 * ddo);      //  0.033
+      lat = lat + 0.000296706 * sin(2 * Mo + F);       //  0.017
+
+      // distance terms earth radii
+      ro = ro - 0.58 * cos(Mo - 2 * ddo);
+      ro = ro - 0.46 * cos(2 * ddo);
+      *moon_ro = ro; // used by topocentric()
+    }
+
+    // http://www.stjarnhimlen.se/comp/ppcomp.html#10
+    // jupiter || saturn || uranus)
+    if (object == 5 || object == 6 || object == 7)
+    {
+      Mj = 0.347233254684272 + 1.450112046753E-3 * d; // 19.8950 + 0.0830853001 * d
+      Ma = 5.53211777016887 + 5.837118978783E-4 * d;  // 316.9670 + 0.0334442282 * d
+      Mu = 2.48867370706497 + 2.046539221501E-4 * d;  // 142.5905 + 0.011725806  * d; //deg
+    }
+    if (object == 5)
+    {                                                               // jupiter
+      lon = lon - 0.332 * sin(2 * Mj - 5 * Ma - 1.17984257434817);  // 67.6
+      lon = lon - 0.056 * sin(2 * Mj - 2 * Ma + 0.366519142918809); // 21
+      lon = lon + 0.042 * sin(3 * Mj - 5 * Ma + 0.366519142918809); // 21
+      lon = lon - 0.036 * sin(Mj - 2 * Ma);
+      lon = lon + 0.022 * cos(Mj - Ma);
+      lon = lon + 0.023 * sin(2 * Mj - 3 * Ma + 0.907571211037051); // 52
+      lon = lon - 0.016 * sin(Mj - 5 * Ma - 1.20427718387609);      // 69
+    }
+    else if (object == 6)
+    {                                                                // saturn
+      lon = lon + 0.812 * sin(2 * Mj - 5 * Ma - 1.17984257434817);   // 67.6
+      lon = lon - 0.229 * cos(2 * Mj - 4 * Ma - 0.0349065850398866); // 2
+      lon = lon + 0.119 * sin(Mj - 2 * Ma - 0.0523598775598299);     // 3
+      lon = lon + 0.046 * sin(2 * Mj - 6 * Ma - 1.17984257434817);   // 67.6
+      lon = lon + 0.014 * sin(Mj - 3 * Ma + 0.558505360638185);      // 32
+      lat = lat - 0.020 * cos(2 * Mj - 4 * Ma - 0.0349065850398866); // 2
+      lat = lat + 0.018 * sin(2 * Mj - 6 * Ma - 0.855211333477221);  // 49
+    }
+    else if (object == 7)
+    {                                                           // uranus
+      lon = lon + 0.040 * sin(Ma - 2 * Mu + 0.10471975511966);  // 6
+      lon = lon + 0.035 * sin(Ma - 3 * Mu + 0.575958653158129); // 33
+      lon = lon - 0.015 * sin(Mj - Mu + 0.349065850398866);     // 20
+    }
+
+    // recalculate planets position in 3D space after pertubations
+    // and compute Geocentric (Earth-centered) coordinates
+
+    // http://www.stjarnhimlen.se/comp/ppcomp.html#11
+
+    xh = ro * cos(lon) * cos(lat);
+    yh = ro * sin(lon) * cos(lat);
+    zh = ro * sin(lat);
+
+    if (object == 3)
+    { // moon is viewed directly from the earth
+      xg = xh;
+      yg = yh;
+      zg = zh;
+    }
+    else
+    { // add the sun's (=earth) position
+      xg = xh + rs * cos(lonsun);
+      yg = yh + rs * sin(lonsun);
+      zg = zh;
+    }
+  }
+
+  // rotate to equatorial coords
+  orbitEquatorial(d, xg, yg, zg, object_ra, object_dc);
+
+}
+
+/**
+ * pseudo random, the same every run
+ */
+static uint64_t random64()
+{
+  static uint64_t seed = 88172645463325252ull;
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+
+int main()
+{
+  long checked = 0;
+  long differ = 0;
+
+  for (long n = 0; n < 200000; n++)
+  {
+    time_t t = 631152000L + (long)(random64() % 1577836800ull); // 1990 to 2040
+    for (int object = 0; object <= 8; object++)
+    {
+      double ra;
+      double dc;
+      double ro;
+      double inline_ra;
+      double inline_dc;
+      double inline_ro = 0.0;
+
+      getObject(object, t, &ra, &dc, &ro);
+      inlinePlanet(object, t, &inline_ra, &inline_dc, &inline_ro);
+      checked++;
+      if ((ra != inline_ra || dc != inline_dc || ro != inline_ro) && differ++ < 5)
+        printf("object %d at %ld: ra %.17g, %.17g inline; dc %.17g, %.17g inline; ro %.17g, %.17g inline\n",
+               object, (long)t, ra, inline_ra, dc, inline_dc, ro, inline_ro);
+    }
+  }
+  printf("%ld positions, %ld differ\n", checked, differ);
+  printf("%s\n", differ ? "FAIL" : "ok");
+  return differ ? 1 : 0;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file powersim.cpp
+ * @brief Host simulation of the sleep charge of a night of tracking
+ *
+ * Runs the body of loop() of the firmware, time_sync(), update_pointer(),
+ * aging_update() and sleep(), through a 12 hour night from Utrecht
+ * (2021-10-17 18:00 UTC and the nights after), for the moon and the six
+ * stars, one night each. battery_check() is left out, it waits for the ADC.
+ *
+ * The RTC runs on the true time of the simulation. A watchdog slice takes
+ * exactly sleep_granularity seconds. With RTC_ALARM the processor sleeps
+ * until an enabled alarm of the RTC matches and pulls INT/SQW low, as the
+ * alarm registers say: alarm 1 of a DS3232 or alarm 2 of a DS3231, with the
+ * watchdog slices after it.
+ *
+ * The charge asleep is modelled for 3.3 V at 8 MHz: power down draws 4.2 uA
+ * with the watchdog and 0.1 uA without, a wake up costs 2 ms of start up at
+ * 0.5 mA plus 0.1 ms at 4 mA. The motors are not included. Printed are the
+ * pointer updates, the wake ups and the charge per night, the average over
+ * the objects. A sleep past the end of the night, until the object rises
+ * again, only counts up to the end. The exit status is not 0 if an alarm never comes.
+ *
+ * Build with and without RTC_ALARM, see power.h, and run the alarm build
+ * for a DS3232 and with ds3231 for a DS3231.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -DRTC_ALARM -Itools/host -Iinclude -Ilib/Time -Ilib/DS3232RTC/src -o powersim tools/powersim.cpp src/*.cpp lib/Time/Time.cpp lib/DS3232RTC/src/DS3232RTC.cpp tools/host/host.cpp
+ * ./powersim
+ * ./powersim ds3231
+ * ```
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "host.h"
+
+#define night_start 1634493600L // 2021-10-17 18:00 UTC
+#define night 43200L
+#define alarm_search (2 * 86400L) // seconds an alarm is looked for
+
+#define i_watchdog 4.2e-6               // A, power down with the watchdog
+#define i_down 0.1e-6                   // A, power down without
+#define q_wake (2e-3 * 0.5e-3 + 0.1e-3 * 4e-3) // As per wake up
+#define uah 3.6e-3                      // As per uAh
+
+extern double loc_lat, loc_lng;
+
+static double true_s;         // true time, as the RTC keeps it
+static double end_s;          // end of the night, later wake ups are not counted
+static unsigned long last_ms; // millis() at the last wake up
+static long slices;           // watchdog wake ups
+static long alarms;           // alarm wake ups
+static bool lost;             // an alarm never came
+
+/**
+ * @returns value of a BCD register
+ */
+static int bcd(uint8_t value)
+{
+  return (value >> 4) * 10 + (value & 15);
+}
+
+/**
+ * the time awake passed, the processor goes to sleep
+ */
+static void asleep()
+{
+  true_s += (host_ms - last_ms) / 1000.0;
+}
+
+/**
+ * the processor wakes up at the true time
+ */
+static void awake()
+{
+  host_rtc_set((time_t)true_s);
+  last_ms = host_ms;
+}
+
+/**
+ * @param [in] t time
+ * @param [in] reg first register of the alarm, from the minutes
+ * @param [in] day_mask mask bit of the day/date register
+ * @returns true if the minutes, hours and day of t match the alarm
+ */
+static bool matches(time_t t, int reg, bool day_mask)
+{
+  tmElements_t tm;
+  breakTime(t, tm);
+  uint8_t day = host_rtc[reg + 2];
+
+  return (host_rtc[reg] & 0x80 || bcd(host_rtc[reg] & 0x7f) == tm.Minute) &&
+         (host_rtc[reg + 1] & 0x80 || bcd(host_rtc[reg + 1] & 0x3f) == tm.Hour) &&
+         (day_mask || (day & 0x40 ? (day & 0x0f) == tm.Wday : bcd(day & 0x3f) == tm.Day));
+}
+
+/**
+ * alarm_wait() sleeps: until the next second an enabled alarm matches
+ */
+static void alarm_sleep()
+{
+  asleep();
+  uint8_t enabled = host_rtc[0x0e] & 3;
+  for (time_t t = (time_t)true_s + 1; t < true_s + alarm_search; t++)
+  {
+    bool one = enabled & 1 && (host_rtc[0x07] & 0x80 || bcd(host_rtc[0x07] & 0x7f) == second(t)) &&
+               matches(t, 0x08, host_rtc[0x0a] & 0x80);
+    bool two = enabled & 2 && second(t) == 0 && matches(t, 0x0b, host_rtc[0x0d] & 0x80);
+    if (one || two)
+    {
+      true_s = t;
+      host_rtc[0x0f] |= (one ? 1 : 0) | (two ? 2 : 0);
+      if (true_s <= end_s)
+        alarms++;
+      awake();
+      return;
+    }
+  }
+  lost = true;
+  true_s += alarm_search;
+  awake();
+}
+
+/**
+ * a watchdog slice
+ */
+static void slice(period_t period)
+{
+  asleep();
+  true_s += sleep_granularity;
+  if (true_s <= end_s)
+    slices++;
+  awake();
+}
+
+/**
+ * INT/SQW is low while an enabled alarm flag is set
+ */
+static int pin(uint8_t p)
+{
+  if (p == rtc_alarm_pin)
+    return host_rtc[0x0f] & host_rtc[0x0e] & 3 ? LOW : HIGH;
+  return HIGH;
+}
+
+int main(int argc, char **argv)
+{
+  const int objects[] = {3, 9, 10, 11, 12, 13, 14};
+  const int count = sizeof(objects) / sizeof(objects[0]);
+  long updates = 0;
+  double charge = 0.0;
+
+  host_rtc_sram = argc < 2 || strcmp(argv[1], "ds3231") != 0;
+  host_rtc[0x0e] = 0x1c; // control register at power up
+  host_sleep = alarm_sleep;
+  host_power_down = slice;
+  host_digital_read = pin;
+
+  true_s = night_start;
+  awake();
+  setTime(night_start);
+  power_on();
+  getLocation(0, &loc_lat, &loc_lng);
+  for (int n = 0; n < count; n++)
+  {
+    time_t start = night_start + n * 86400L;
+    long wakes = slices + alarms;
+    double watchdog_s = slices * (double)sleep_granularity;
+
+    true_s = start;
+    end_s = start + night;
+    awake();
+    setTime(start);
+    store_set(store_object, objects[n]);
+    trajectory_clear();
+    clearHorizontalCache();
+    while (true_s < start + night)
+    {
+      time_sync();
+      unsigned long seconds = update_pointer();
+      aging_update(now());
+      sleep(seconds);
+      updates++;
+    }
+    wakes = slices + alarms - wakes;
+    watchdog_s = slices * (double)sleep_granularity - watchdog_s;
+    charge += (i_watchdog * watchdog_s + i_down * (night - watchdog_s) + wakes * q_wake) / uah;
+  }
+
+  printf("%s%s: %.0f updates, %.0f wake ups (%.0f by the watchdog), %.1f uAh per night\n",
+#ifdef RTC_ALARM
+         host_rtc_sram ? "DS3232" : "DS3231", " alarm",
+#else
+         "watchdog", " only",
+#endif
+         (double)updates / count, (double)(slices + alarms) / count, (double)slices / count,
+         charge / count);
+  printf("%s\n", lost ? "FAIL" : "ok");
+  return lost ? 1 : 0;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file risecheck.cpp
+ * @brief Host test of getRise() and getRiseSet(), and their evaluations
+ *
+ * First the Sun from Utrecht (52.09, 5.12) on 2021-06-21, with the upper
+ * limb at the horizon through the standard refraction, -0.833 degrees, as
+ * almanacs give it: rise at 03:19 and set at 20:04 UTC, to the minute.
+ * With riseset_horizon, the center at 0 degrees, it is 03:26 and 19:57.
+ *
+ * Then every object from Utrecht, from starts a week and five hours apart
+ * over 2024. getRise() has to give the rise getRiseSet() gives, and both
+ * have to be within riseset_precision of the first rise a scan of the
+ * altitude every 10 seconds finds in the window. A rise and a set within one
+ * riseset_step both searches miss, those are counted apart.
+ *
+ * riseset.cpp is compiled into this file, with getObject() and
+ * getHorizontal() renamed to wrappers that count the evaluations. Printed
+ * are the evaluations per search of getRiseSet() and of getRise(), the
+ * average and the most, refinements included.
+ *
+ * The exit status is not 0 if a time is off, or getRise() and getRiseSet()
+ * differ.
+ *
+ * Build and run from the root of the project, without src/riseset.cpp
+ * ```
+ * g++ -O2 -DARDUINO=10800 -Itools/host -Iinclude -Ilib/Time -o risecheck tools/risecheck.cpp src/astronomy.cpp src/skygrid.cpp src/orbit.cpp src/fasttrig.cpp src/satellite.cpp src/apparent.cpp lib/Time/Time.cpp tools/host/host.cpp
+ * ./risecheck
+ * ```
+ */
+
+#include <stdio.h>
+
+#include "astronomy.h"
+#include "riseset.h"
+
+#define lat 52.09
+#define lng 5.12
+#define year_start 1704067200L // 2024-01-01 00:00 UTC
+#define year_end 1735689600L   // 2025-01-01 00:00 UTC
+#define start_step (86400L * 7 + 3600L * 5)
+#define scan_step 10
+#define almanac_horizon -0.833 // upper limb and refraction, degrees
+
+static long evaluations;
+
+static void countedObject(int index, time_t now, double *object_ra, double *object_dc,
+                          double *object_ro)
+{
+  evaluations++;
+  getObject(index, now, object_ra, object_dc, object_ro);
+}
+
+static void countedHorizontal(int index, time_t now, double loc_lat_d, double sidereal_r,
+                              double *object_az_d, double *object_al_d, bool cached)
+{
+  evaluations++;
+  getHorizontal(index, now, loc_lat_d, sidereal_r, object_az_d, object_al_d, cached);
+}
+
+#define getObject countedObject
+#define getHorizontal countedHorizontal
+#include "../src/riseset.cpp"
+#undef getObject
+#undef getHorizontal
+
+/**
+ * Evaluations of a search
+ */
+struct tally
+{
+  long searches;
+  long total;
+  long most;
+};
+
+static void count(tally *t, long n)
+{
+  t->searches++;
+  t->total += n;
+  if (n > t->most)
+    t->most = n;
+}
+
+/**
+ * @returns the first rise in the window, to within scan_step seconds, 0 if none
+ */
+static time_t scanRise(int index, time_t from)
+{
+  double az, al;
+  getHorizontal(index, from, lat, getSiderealAngle(from, lng), &az, &al, false);
+  bool up = al >= riseset_horizon;
+
+  for (time_t t = from + scan_step; t <= from + riseset_window; t += scan_step)
+  {
+    getHorizontal(index, t, lat, getSiderealAngle(t, lng), &az, &al, false);
+    if (!up && al >= riseset_horizon)
+      return t - scan_step / 2;
+    up = al >= riseset_horizon;
+  }
+  return 0;
+}
+
+/**
+ * @returns true if t is within minutes of hh:mm on the day of day
+ */
+static bool at(const char *name, time_t t, time_t day, int hh, int mm)
+{
+  long minutes = (long)((t - day + 30) / 60);
+  printf("%s %02ld:%02ld UTC (%02d:%02d)\n", name, minutes / 60, minutes % 60, hh, mm);
+  return minutes == hh * 60L + mm;
+}
+
+int main()
+{
+  bool ok = true;
+
+  time_t day = 1624233600L; // 2021-06-21 00:00 UTC
+  riseset rs;
+  getRiseSet(0, day, lat, lng, almanac_horizon, &rs);
+  ok &= at("Sun rise", rs.rise, day, 3, 19);
+  ok &= at("Sun set ", rs.set, day, 20, 4);
+
+  tally full = {0, 0, 0};
+  tally rise = {0, 0, 0};
+  long differ = 0;
+  long off = 0;
+  long missed = 0;
+
+  for (int index = 0; index <= max_object; index++)
+    for (time_t from = year_start; from < year_end; from += start_step)
+    {
+      evaluations = 0;
+      getRiseSet(index, from, lat, lng, riseset_horizon, &rs);
+      count(&full, evaluations);
+
+      evaluations = 0;
+      time_t r = getRise(index, from, lat, lng, riseset_horizon);
+      count(&rise, evaluations);
+
+      if (r != rs.rise && differ++ < 5)
+        printf("  object %d from %ld: getRise %ld, getRiseSet %ld\n",
+               index, (long)from, (long)r, (long)rs.rise);
+
+      time_t scan = scanRise(index, from);
+      if (r == 0 && scan != 0)
+        missed++;
+      else if ((r == 0) != (scan == 0) || labs((long)(r - scan)) > riseset_precision)
+      {
+        if (off++ < 5)
+          printf("  object %d from %ld: rise %ld, scan %ld\n",
+                 index, (long)from, (long)r, (long)scan);
+      }
+    }
+
+  printf("%ld searches, %ld differ, %ld off, %ld missed within one step\n",
+         rise.searches, differ, off, missed);
+  printf("getRiseSet(): %.1f evaluations on average, %ld at most\n",
+         (double)full.total / full.searches, full.most);
+  printf("getRise():    %.1f evaluations on average, %ld at most\n",
+         (double)rise.total / rise.searches, rise.most);
+
+  ok &= differ == 0 && off == 0;
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
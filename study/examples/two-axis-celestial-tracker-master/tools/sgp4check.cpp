@@ -0,0 +1,165 @@
+/**
+ * @file sgp4check.cpp
+ * @brief Host test of SGP4 and of the rise search for a satellite
+ *
+ * First satellitePosition() against published positions, in km:
+ * - 88888, the test case of Spacetrack Report #3, at 0 to 1440 minutes, as
+ *   printed in the report. Its perigee is below 220 km, so this is the
+ *   simplified drag model
+ * - 00005, from the verification set of Vallado et al., Revisiting
+ *   Spacetrack Report #3 (2006), for the full drag model
+ *
+ * Then getRise() of the satellite, which skips what it can with a coarse
+ * first pass, against the first rise found by getRiseSet(), which scans the
+ * whole window every riseset_step_pass seconds. For 88888, 00005 and the
+ * ISS, from four latitudes, every 421 seconds over two days from the epoch.
+ * Printed is the average time of a search on this host, also as a number of
+ * evaluations of the position, next to the evaluations of the scan of every
+ * riseset_step_pass seconds until the rise.
+ *
+ * The exit status is not 0 if a position is more than 0.1 km off, or a rise
+ * differs.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -DSATELLITE -Itools/host -Iinclude -Ilib/Time -o sgp4check tools/sgp4check.cpp src/riseset.cpp src/astronomy.cpp src/skygrid.cpp src/orbit.cpp src/fasttrig.cpp src/satellite.cpp src/apparent.cpp lib/Time/Time.cpp tools/host/host.cpp
+ * ./sgp4check
+ * ```
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "astronomy.h"
+#include "riseset.h"
+#include "satellite.h"
+
+#define earth_radius 6378.135 // km, WGS-72 as in satellite.cpp
+#define start_step 421        // seconds between the starts of the searches
+#define span (2 * 86400L)     // seconds from the epoch
+
+/**
+ * A TLE with published positions
+ */
+struct vectors
+{
+  const char *name;
+  const char *line1;
+  const char *line2;
+  double km[5][4]; // minutes since epoch, x, y, z
+};
+
+static const vectors published[] = {
+    {"88888",
+     "1 88888U          80275.98708465  .00073094  13844-3  66816-4 0     8",
+     "2 88888  72.8435 115.9689 0086731  52.6988 110.5714 16.05824518   105",
+     {{0, 2328.97048951, -5995.22076416, 1719.97067261},
+      {360, 2456.10705566, -6071.93853760, 1222.89727783},
+      {720, 2567.56195068, -6112.50384522, 713.96397400},
+      {1080, 2663.09078980, -6115.48229980, 196.39640427},
+      {1440, 2742.55133057, -6079.67144775, -326.38095856}}},
+    {"00005",
+     "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753",
+     "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667",
+     {{0, 7022.46529266, -1400.08296755, 0.03995155},
+      {360, -7154.03120202, -3783.17682504, -3536.19412294},
+      {720, -7134.59340119, 6531.68641334, 3260.27186483},
+      {1080, 5568.53901181, 4492.06992591, 3863.87641983},
+      {1440, -938.55923943, -6268.18748831, -4294.02924751}}},
+};
+
+static const char *iss[] = {
+    "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+    "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537"};
+
+/**
+ * @returns the largest distance from the published positions in km
+ */
+static double positions(const vectors *v)
+{
+  satellite_elements el;
+  double worst = 0.0;
+
+  satelliteTle(v->line1, v->line2, &el);
+  satelliteInit(&el);
+  for (int n = 0; n < 5; n++)
+  {
+    double x, y, z;
+    satellitePosition(v->km[n][0], &x, &y, &z);
+    double dx = x * earth_radius - v->km[n][1];
+    double dy = y * earth_radius - v->km[n][2];
+    double dz = z * earth_radius - v->km[n][3];
+    worst = fmax(worst, sqrt(dx * dx + dy * dy + dz * dz));
+  }
+  return worst;
+}
+
+/**
+ * compare the rise searches for one satellite
+ * @param [in] name of the satellite
+ * @param [in] line1 first line of the TLE
+ * @param [in] line2 second line of the TLE
+ * @returns number of rises that differ
+ */
+static long rises(const char *name, const char *line1, const char *line2)
+{
+  const double latitudes[] = {52.09, 0.0, 70.0, -35.0};
+  satellite_elements el;
+  long differ = 0;
+  long searches = 0;
+  double scan = 0.0; // evaluations of the scan every riseset_step_pass
+  double seconds = 0.0;
+
+  satelliteTle(line1, line2, &el);
+  satelliteInit(&el);
+  for (unsigned k = 0; k < sizeof(latitudes) / sizeof(latitudes[0]); k++)
+    for (time_t from = el.epoch; from < el.epoch + span; from += start_step)
+    {
+      riseset rs;
+      getRiseSet(object_satellite, from, latitudes[k], 5.12, riseset_horizon, &rs);
+
+      clock_t start = clock();
+      time_t rise = getRise(object_satellite, from, latitudes[k], 5.12, riseset_horizon);
+      seconds += (double)(clock() - start) / CLOCKS_PER_SEC;
+
+      if (rise != rs.rise && differ++ < 5)
+        printf("  %s from %ld at %.2f: rise %ld, scan %ld\n", name, (long)from,
+               latitudes[k], (long)rise, (long)rs.rise);
+      scan += rs.rise ? (rs.rise - from) / riseset_step_pass + 5 : riseset_window / riseset_step_pass + 1;
+      searches++;
+    }
+
+  // time of one evaluation, as riseSetValue() does it
+  clock_t start = clock();
+  for (long n = 0; n < 100000; n++)
+  {
+    double az, al;
+    getHorizontal(object_satellite, el.epoch + n, 52.09, getSiderealAngle(el.epoch + n, 5.12),
+                  &az, &al, false);
+  }
+  double evaluation = (double)(clock() - start) / CLOCKS_PER_SEC / 100000;
+
+  printf("%s: %ld searches, %ld differ, %.0f us per search, as %.0f evaluations, scan %.0f\n",
+         name, searches, differ, seconds / searches * 1e6, seconds / searches / evaluation,
+         scan / searches);
+  return differ;
+}
+
+int main()
+{
+  bool ok = true;
+
+  for (unsigned n = 0; n < sizeof(published) / sizeof(published[0]); n++)
+  {
+    double km = positions(&published[n]);
+    printf("%s: %.4f km at most from the published positions\n", published[n].name, km);
+    ok &= km <= 0.1;
+  }
+
+  for (unsigned n = 0; n < sizeof(published) / sizeof(published[0]); n++)
+    ok &= rises(published[n].name, published[n].line1, published[n].line2) == 0;
+  ok &= rises("ISS", iss[0], iss[1]) == 0;
+
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file siderealcheck.cpp
+ * @brief Host test of the incremental sidereal clock
+ *
+ * getSiderealClock() advances the sidereal time of its last call with 32 bit
+ * arithmetic, instead of the 64 bit modulo of getSiderealAngle(). This calls
+ * both at the same times, from 2000 to 2100, and they have to give the same
+ * angle, i.e. the same ms in the sidereal day. The times advance from 1 s
+ * to over sidereal_max_advance apart, jump back now and then and the
+ * longitude changes now and then, so the clock advances as well as seeds
+ * again. The angles are also compared as ms in the sidereal day, which is
+ * the resolution of both. The exit status is not 0 if any differ.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -Itools/host -Iinclude -Ilib/Time -o siderealcheck tools/siderealcheck.cpp src/astronomy.cpp src/skygrid.cpp src/orbit.cpp src/fasttrig.cpp src/satellite.cpp src/apparent.cpp lib/Time/Time.cpp tools/host/host.cpp
+ * ./siderealcheck
+ * ```
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "astronomy.h"
+
+#define year_2000 946684800UL
+#define year_2100 4102444800UL
+
+/**
+ * pseudo random, the same every run
+ */
+static uint32_t random32()
+{
+  static uint32_t seed = 1;
+  seed = seed * 1103515245UL + 12345UL;
+  return seed >> 8;
+}
+
+/**
+ * @returns the angle as ms in the sidereal day
+ */
+static double sidereal_ms(double sidereal_r)
+{
+  return sidereal_r / (2.0 * pi) * solar_ms_seconds_per_sidereal_day;
+}
+
+int main()
+{
+  const double longitudes[] = {5.119823, -122.4194, 0.0, 179.9, -45.5};
+  double lng = longitudes[0];
+  long checked = 0;
+  long differ = 0;
+  long jumps = 0;
+  long seeds = 0;
+  double worst_ms = 0.0;
+
+  for (unsigned long t = year_2000; t < year_2100;)
+  {
+    double clock = getSiderealClock(t, lng);
+    double angle = getSiderealAngle(t, lng);
+    double ms = fabs(sidereal_ms(clock) - sidereal_ms(angle));
+
+    checked++;
+    if (ms > worst_ms)
+      worst_ms = ms;
+    if (clock != angle && differ++ < 5)
+      printf("%lu at %.4f: clock %.9f, angle %.9f, %.3f ms\n", t, lng, clock, angle, ms);
+
+    uint32_t r = random32();
+    switch (r % 1000)
+    {
+    case 0: // back
+      t -= r % 86400;
+      jumps++;
+      break;
+    case 1: // another location
+      lng = longitudes[r / 1000 % 5];
+      seeds++;
+      break;
+    case 2: // the longest advance without a seed
+      t += sidereal_max_advance - r / 1000 % 100;
+      break;
+    case 3: // the clock has to seed again
+      t += sidereal_max_advance + 1 + r % 100000;
+      seeds++;
+      break;
+    default: // a wake up, seconds to hours later
+      t += r % 4 ? 1 + r % 60 : 1 + r % 7200;
+    }
+  }
+  printf("%ld times, %ld back, %ld seeds: %ld differ, at most %.3f ms\n",
+         checked, jumps, seeds, differ, worst_ms);
+  printf("%s\n", differ ? "FAIL" : "ok");
+  return differ ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+/**
+ * @file skybench.cpp
+ * @brief Host benchmark of the sky grid searches against a brute force scan
+ *
+ * Catalogs of 10000 and 100000 pseudo random stars, evenly over the sky,
+ * are sorted on sky grid cell as the catalog in skygrid.cpp. On each,
+ * skyCatalogBrightestNear() with radii of 2 and 10 degrees and
+ * skyCatalogAboveHorizon() for altitudes of 0 and 30 degrees run at pseudo
+ * random directions, latitudes and sidereal times, and so does a scan of
+ * every star that computes the same angular distance. They have to find the
+ * same: the same magnitude at the same distance, and the same number of
+ * stars above the altitude. Printed is the time per search of both.
+ *
+ * A grid of 6 by 6 cells suits the six stars on the device, these catalogs
+ * get 16 by 16, the most the uint8_t cell allows. The cells in the device
+ * catalog are not right for that grid, which does not matter here.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -Dskygrid_bands=16 -Dskygrid_ra_cells=16 -Itools/host -Iinclude -Ilib/Time -o skybench tools/skybench.cpp src/skygrid.cpp lib/Time/Time.cpp tools/host/host.cpp
+ * ./skybench
+ * ```
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "astronomy.h"
+#include "skygrid.h"
+
+#define near_searches 1000L
+#define horizon_searches 100L
+
+/**
+ * pseudo random in [0, 1), the same every run
+ */
+static double random01()
+{
+  static uint64_t seed = 88172645463325252ull;
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return (seed >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * qsort order on cell
+ */
+static int by_cell(const void *a, const void *b)
+{
+  return (int)((const star *)a)->cell - (int)((const star *)b)->cell;
+}
+
+/**
+ * cosine of the angular distance of a star, as skySearch() computes it
+ */
+static double cos_distance(const star *s, double ra_r, double sin_dc, double cos_dc)
+{
+  double star_dc_r = s->dc_d / 180.0 * pi;
+  return sin_dc * sin(star_dc_r) + cos_dc * cos(star_dc_r) * cos(s->ra_h / 12.0 * pi - ra_r);
+}
+
+/**
+ * brute force skyCatalogBrightestNear()
+ */
+static int scanBrightestNear(const star *catalog, int count,
+                             double ra_h, double dc_d, double radius_d)
+{
+  double ra_r = ra_h / 12.0 * pi;
+  double sin_dc = sin(dc_d / 180.0 * pi);
+  double cos_dc = cos(dc_d / 180.0 * pi);
+  double cos_radius = cos(radius_d / 180.0 * pi);
+  int best = skygrid_none;
+  double best_cos = 0.0;
+
+  for (int n = 0; n < count; n++)
+  {
+    double c = cos_distance(&catalog[n], ra_r, sin_dc, cos_dc);
+    if (c >= cos_radius &&
+        (best == skygrid_none || catalog[n].mag10 < catalog[best].mag10 ||
+         (catalog[n].mag10 == catalog[best].mag10 && c > best_cos)))
+    {
+      best = n;
+      best_cos = c;
+    }
+  }
+  return best;
+}
+
+/**
+ * brute force skyCatalogAboveHorizon()
+ */
+static int scanAboveHorizon(const star *catalog, int count,
+                            double loc_lat_d, double sidereal_r, double min_al_d)
+{
+  double sin_dc = sin(loc_lat_d / 180.0 * pi);
+  double cos_dc = cos(loc_lat_d / 180.0 * pi);
+  double cos_radius = cos((90.0 - min_al_d) / 180.0 * pi);
+  int found = 0;
+
+  for (int n = 0; n < count; n++)
+    if (cos_distance(&catalog[n], sidereal_r, sin_dc, cos_dc) >= cos_radius)
+      found++;
+  return found;
+}
+
+/**
+ * @returns the same star or an equally bright one as near
+ */
+static bool same(const star *catalog, int a, int b, double ra_h, double dc_d)
+{
+  if (a == b)
+    return true;
+  if (a == skygrid_none || b == skygrid_none)
+    return false;
+  double sin_dc = sin(dc_d / 180.0 * pi);
+  double cos_dc = cos(dc_d / 180.0 * pi);
+  return catalog[a].mag10 == catalog[b].mag10 &&
+         cos_distance(&catalog[a], ra_h / 12.0 * pi, sin_dc, cos_dc) ==
+             cos_distance(&catalog[b], ra_h / 12.0 * pi, sin_dc, cos_dc);
+}
+
+/**
+ * @returns seconds since start
+ */
+static double since(clock_t start)
+{
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * benchmark one catalog size
+ * @returns number of searches that differ
+ */
+static long bench(int count)
+{
+  star *catalog = (star *)malloc(count * sizeof(star));
+  long differ = 0;
+
+  for (int n = 0; n < count; n++)
+  {
+    catalog[n].ra_h = random01() * 24.0;
+    catalog[n].dc_d = asin(random01() * 2.0 - 1.0) * 180.0 / pi;
+    catalog[n].mag10 = -15 + (int)(random01() * 115.0);
+    catalog[n].index = 0;
+    catalog[n].cell = skyCell(catalog[n].ra_h, catalog[n].dc_d);
+  }
+  qsort(catalog, count, sizeof(star), by_cell);
+
+  const double radii[] = {2.0, 10.0};
+  for (int k = 0; k < 2; k++)
+  {
+    double grid = 0.0;
+    double scan = 0.0;
+    for (long q = 0; q < near_searches; q++)
+    {
+      double ra_h = random01() * 24.0;
+      double dc_d = asin(random01() * 2.0 - 1.0) * 180.0 / pi;
+
+      clock_t start = clock();
+      int a = skyCatalogBrightestNear(catalog, count, ra_h, dc_d, radii[k]);
+      grid += since(start);
+      start = clock();
+      int b = scanBrightestNear(catalog, count, ra_h, dc_d, radii[k]);
+      scan += since(start);
+      if (!same(catalog, a, b, ra_h, dc_d))
+        differ++;
+    }
+    printf("%6d stars, brightest within %4.1f deg: grid %8.2f us, scan %8.2f us, %.1f times\n",
+           count, radii[k], grid / near_searches * 1e6, scan / near_searches * 1e6, scan / grid);
+  }
+
+  const double altitudes[] = {0.0, 30.0};
+  for (int k = 0; k < 2; k++)
+  {
+    double grid = 0.0;
+    double scan = 0.0;
+    for (long q = 0; q < horizon_searches; q++)
+    {
+      double lat_d = random01() * 180.0 - 90.0;
+      double sidereal_r = random01() * 2.0 * pi;
+
+      clock_t start = clock();
+      int a = skyCatalogAboveHorizon(catalog, count, lat_d, sidereal_r, altitudes[k]);
+      grid += since(start);
+      start = clock();
+      int b = scanAboveHorizon(catalog, count, lat_d, sidereal_r, altitudes[k]);
+      scan += since(start);
+      if (a != b)
+        differ++;
+    }
+    printf("%6d stars, above %4.1f deg:         grid %8.2f us, scan %8.2f us, %.1f times\n",
+           count, altitudes[k], grid / horizon_searches * 1e6, scan / horizon_searches * 1e6,
+           scan / grid);
+  }
+
+  free(catalog);
+  return differ;
+}
+
+int main()
+{
+  long differ = bench(10000) + bench(100000);
+
+  printf("%ld searches differ\n%s\n", differ, differ ? "FAIL" : "ok");
+  return differ ? 1 : 0;
+}
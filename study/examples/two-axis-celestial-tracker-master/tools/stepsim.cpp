@@ -0,0 +1,142 @@
+/**
+ * @file stepsim.cpp
+ * @brief Host simulation of the pointing error of full and half steps
+ *
+ * Runs update_pointer() of the firmware, as loop() does, through a 13 hour
+ * night from Utrecht (2021-10-17 18:00 UTC), for the moon and the six stars.
+ * The time asleep is rounded down to whole watchdog slices, as sleep() does.
+ * Every 10 seconds, while the object is above the horizon, the pointer is
+ * compared with the exact position of getHorizontal(): the angle on the sky
+ * in degrees.
+ *
+ * Printed are the mean, the 95th percentile and the largest error, the wake
+ * ups, the steps and the time the motors run, which is the time spent in
+ * steps of the Timer1 ISR. Build with and without HALF_STEP, see stepper.h,
+ * to compare. The exit status is not 0 if the pointer is ever further off
+ * than a degree.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -DHALF_STEP -Itools/host -Iinclude -Ilib/Time -Ilib/DS3232RTC/src -o stepsim tools/stepsim.cpp src/*.cpp lib/Time/Time.cpp lib/DS3232RTC/src/DS3232RTC.cpp tools/host/host.cpp
+ * ./stepsim
+ * ```
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "main.h"
+#include "host.h"
+
+#define night_start 1634493600L // 2021-10-17 18:00 UTC
+#define night (13 * 3600L)
+#define sample 10               // seconds between comparisons
+#define max_samples (7 * night / sample)
+
+extern double loc_lat, loc_lng;
+
+static double errors[max_samples];
+static long samples;
+
+/**
+ * qsort order
+ */
+static int by_value(const void *a, const void *b)
+{
+  double d = *(const double *)a - *(const double *)b;
+  return d < 0 ? -1 : d > 0 ? 1 : 0;
+}
+
+/**
+ * keep the pointer error at t, if the object is above the horizon
+ * @param [in] index of the object
+ * @param [in] t time in UTC
+ * @param [in] az pointer azimuth in ticks
+ * @param [in] al pointer altitude in ticks
+ */
+static void compare(int index, time_t t, int az, int al)
+{
+  double object_az_d;
+  double object_al_d;
+
+  getHorizontal(index, t, loc_lat, getSiderealAngle(t, loc_lng),
+                &object_az_d, &object_al_d, false);
+  if (object_al_d < riseset_horizon)
+    return;
+  double daz = remainder(object_az_d + az * 360.0 / steps_per_revolution, 360.0);
+  double dal = object_al_d - al * 360.0 / steps_per_revolution;
+  daz *= cos(object_al_d / 180.0 * pi);
+  errors[samples++] = sqrt(daz * daz + dal * dal);
+}
+
+/**
+ * simulate the night for one object
+ * @param [in] index of the object
+ * @param [out] steps azimuth and altitude steps
+ * @returns number of wake ups
+ */
+static long simulate(int index, long *steps)
+{
+  long wakes = 0;
+  time_t t = night_start;
+
+  store_set(store_object, index);
+  trajectory_clear();
+  clearHorizontalCache();
+  setTime(t);
+  update_pointer(); // to the object, not counted
+  host_timer_us = 0.0;
+  int az = journal_read(0);
+  int al = journal_read(1);
+
+  while (t < night_start + night)
+  {
+    setTime(t);
+    unsigned long seconds = update_pointer() / sleep_granularity * sleep_granularity;
+    if (seconds == 0)
+      seconds = sleep_granularity;
+    wakes++;
+
+    int next_az = journal_read(0);
+    int next_al = journal_read(1);
+    *steps += abs(next_az - az) + abs(next_al - al);
+    az = next_az;
+    al = next_al;
+    time_t u = t + (sample - (t - night_start) % sample) % sample; // on the grid
+    for (; u < t + (time_t)seconds && u < night_start + night; u += sample)
+      compare(index, u, az, al);
+    t += seconds;
+  }
+  return wakes;
+}
+
+int main()
+{
+  const int objects[] = {3, 9, 10, 11, 12, 13, 14};
+  long wakes = 0;
+  long steps = 0;
+  double motor_s = 0.0;
+
+  host_rtc_set(night_start);
+  setTime(night_start);
+  power_on();
+  getLocation(0, &loc_lat, &loc_lng);
+  for (unsigned n = 0; n < sizeof(objects) / sizeof(objects[0]); n++)
+  {
+    wakes += simulate(objects[n], &steps);
+    motor_s += host_timer_us * 1e-6;
+  }
+
+  qsort(errors, samples, sizeof(double), by_value);
+  double mean = 0.0;
+  for (long n = 0; n < samples; n++)
+    mean += errors[n];
+  mean /= samples;
+  double most = errors[samples - 1];
+
+  printf("%d steps per revolution: error mean %.3f, p95 %.3f, max %.3f deg\n",
+         steps_per_revolution, mean, errors[samples * 95 / 100], most);
+  printf("%ld wake ups, %ld steps, motors on %.1f s\n", wakes, steps, motor_s);
+  printf("%s\n", most <= 1.0 ? "ok" : "FAIL");
+  return most <= 1.0 ? 0 : 1;
+}
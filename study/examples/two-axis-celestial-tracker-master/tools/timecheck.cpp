@@ -0,0 +1,194 @@
+/**
+ * @file timecheck.cpp
+ * @brief Host test of the date conversions of lib/Time
+ *
+ * breakTime() and makeTime() count days from 1 March 1968 instead of looping
+ * over the years and months since 1970. This compares them with the loop
+ * versions they replaced, which are kept below:
+ * - breakTime() for every day from 1970 to the end of a 32 bit time_t in
+ *   2106, at the first, the last and a pseudo random second of the day, and
+ *   makeTime() of the result, which has to give back the same time
+ * - makeTime() for day 1 to 31 of every month from 1970 to 2106, which
+ *   includes dates past the end of a month; both versions roll those over
+ *   into the next month
+ * The exit status is not 0 if any differ.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=100 -Itools/host -Ilib/Time -o timecheck tools/timecheck.cpp lib/Time/Time.cpp
+ * ./timecheck
+ * ```
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "TimeLib.h"
+
+unsigned long millis()
+{
+  return 0;
+}
+
+// the loop versions, as in Time.cpp before
+
+// leap year calulator expects year argument as years offset from 1970
+#define LEAP_YEAR(Y) (((1970 + Y) > 0) && !((1970 + Y) % 4) && (((1970 + Y) % 100) || !((1970 + Y) % 400)))
+
+static const uint8_t monthDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+static void loopBreakTime(time_t timeInput, tmElements_t &tm)
+{
+  uint8_t year;
+  uint8_t month, monthLength;
+  uint32_t time;
+  unsigned long days;
+
+  time = (uint32_t)timeInput;
+  tm.Second = time % 60;
+  time /= 60; // now it is minutes
+  tm.Minute = time % 60;
+  time /= 60; // now it is hours
+  tm.Hour = time % 24;
+  time /= 24; // now it is days
+  tm.Wday = ((time + 4) % 7) + 1; // Sunday is day 1
+
+  year = 0;
+  days = 0;
+  while ((unsigned)(days += (LEAP_YEAR(year) ? 366 : 365)) <= time)
+    year++;
+  tm.Year = year; // year is offset from 1970
+
+  days -= LEAP_YEAR(year) ? 366 : 365;
+  time -= days; // now it is days in this year, starting at 0
+
+  for (month = 0; month < 12; month++)
+  {
+    if (month == 1) // february
+      monthLength = LEAP_YEAR(year) ? 29 : 28;
+    else
+      monthLength = monthDays[month];
+    if (time >= monthLength)
+      time -= monthLength;
+    else
+      break;
+  }
+  tm.Month = month + 1; // jan is month 1
+  tm.Day = time + 1;    // day of month
+}
+
+static time_t loopMakeTime(tmElements_t &tm)
+{
+  int i;
+  uint32_t seconds;
+
+  // seconds from 1970 till 1 jan 00:00:00 of the given year
+  seconds = tm.Year * (SECS_PER_DAY * 365);
+  for (i = 0; i < tm.Year; i++)
+    if (LEAP_YEAR(i))
+      seconds += SECS_PER_DAY; // add extra days for leap years
+
+  // add days for this year, months start from 1
+  for (i = 1; i < tm.Month; i++)
+    if ((i == 2) && LEAP_YEAR(tm.Year))
+      seconds += SECS_PER_DAY * 29;
+    else
+      seconds += SECS_PER_DAY * monthDays[i - 1];
+  seconds += (tm.Day - 1) * SECS_PER_DAY;
+  seconds += tm.Hour * SECS_PER_HOUR;
+  seconds += tm.Minute * SECS_PER_MIN;
+  seconds += tm.Second;
+  return (time_t)seconds;
+}
+
+/**
+ * pseudo random, the same every run
+ */
+static uint32_t random32()
+{
+  static uint32_t seed = 1;
+  seed = seed * 1103515245UL + 12345UL;
+  return seed >> 8;
+}
+
+static bool same(const tmElements_t &a, const tmElements_t &b)
+{
+  return a.Second == b.Second && a.Minute == b.Minute && a.Hour == b.Hour &&
+         a.Wday == b.Wday && a.Day == b.Day && a.Month == b.Month && a.Year == b.Year;
+}
+
+/**
+ * breakTime() and the round trip through makeTime() for every day
+ * @returns number of times that differ
+ */
+static long checkBreak()
+{
+  long checked = 0;
+  long differ = 0;
+
+  for (uint64_t day = 0; day * SECS_PER_DAY <= 0xffffffffULL; day++)
+  {
+    unsigned long second[] = {0, SECS_PER_DAY - 1, random32() % SECS_PER_DAY};
+    for (int k = 0; k < 3; k++)
+    {
+      uint64_t t64 = day * SECS_PER_DAY + second[k];
+      if (t64 > 0xffffffffULL)
+        t64 = 0xffffffffULL;
+      time_t t = (time_t)t64;
+      tmElements_t loop;
+      tmElements_t now;
+
+      loopBreakTime(t, loop);
+      breakTime(t, now);
+      checked++;
+      if (!same(loop, now) || (uint32_t)makeTime(now) != (uint32_t)t)
+      {
+        if (differ++ < 5)
+          printf("breakTime %lu: loop %d-%d-%d, now %d-%d-%d, back %lu\n", (unsigned long)t,
+                 loop.Year + 1970, loop.Month, loop.Day, now.Year + 1970, now.Month, now.Day,
+                 (unsigned long)(uint32_t)makeTime(now));
+      }
+    }
+  }
+  printf("breakTime: %ld times, %ld differ\n", checked, differ);
+  return differ;
+}
+
+/**
+ * makeTime() for day 1 to 31 of every month
+ * @returns number of dates that differ
+ */
+static long checkMake()
+{
+  long checked = 0;
+  long differ = 0;
+
+  for (int year = 0; year <= 136; year++)
+    for (int month = 1; month <= 12; month++)
+      for (int day = 1; day <= 31; day++)
+      {
+        tmElements_t tm = {};
+        tm.Year = year;
+        tm.Month = month;
+        tm.Day = day;
+        tm.Hour = random32() % 24;
+        tm.Minute = random32() % 60;
+        tm.Second = random32() % 60;
+        checked++;
+        uint32_t loop = loopMakeTime(tm);
+        uint32_t now = makeTime(tm);
+        if (loop != now && differ++ < 5)
+          printf("makeTime %d-%d-%d: loop %lu, now %lu\n", year + 1970, month, day,
+                 (unsigned long)loop, (unsigned long)now);
+      }
+  printf("makeTime: %ld dates, %ld differ\n", checked, differ);
+  return differ;
+}
+
+int main()
+{
+  long differ = checkBreak() + checkMake();
+
+  printf("%s\n", differ ? "FAIL" : "ok");
+  return differ ? 1 : 0;
+}
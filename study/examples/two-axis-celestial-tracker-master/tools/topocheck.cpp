@@ -0,0 +1,160 @@
+/**
+ * @file topocheck.cpp
+ * @brief Host test of topocentric() against Meeus chapter 40
+ *
+ * First example 40.a of Meeus, Astronomical Algorithms: Mars from Palomar,
+ * latitude +33d21'22", on 2003 August 28 at 3:17 UT, at 22h38m07.25s
+ * -15d46'15.9" and a parallax of 23.592", at an hour angle of 288.7958
+ * degrees. Meeus finds 22h38m08.54s -15d46'30.0", to within his rounding.
+ * topocentric() only corrects the moon and the satellite, so Mars is passed
+ * as the moon, at its distance in earth radii.
+ *
+ * Then the rigorous formulas 40.2 and 40.3, with the observer of 40.a at sea
+ * level, for pseudo random latitudes, hour angles and declinations at the
+ * distances of the moon, 55 to 64 earth radii, and of a satellite in low
+ * orbit, 1.03 to 1.2 earth radii, which are passed as the satellite. The
+ * satellite is only compared above the horizon. topocentric() takes the
+ * observer at sea level, with the short series of ppcomp.html#13 for the
+ * geocentric latitude, which puts the observer up to 82 m off. That is what
+ * the differences come from. For scale, the satellite is also compared with
+ * the observer at the height of Palomar, 1706 m, which topocentric() has no
+ * setting for.
+ *
+ * Published topocentric positions of the ISS to compare with were not
+ * available offline, the satellite is only checked against the formulas.
+ *
+ * Printed are the largest differences in arc seconds, of right ascension on
+ * the sky. The exit status is not 0 if Mars is off by more than 0.1", the
+ * moon by more than 1" or the satellite at sea level by more than 60", a
+ * tenth of a step of the pointer.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -DSATELLITE -Itools/host -Iinclude -Ilib/Time -o topocheck tools/topocheck.cpp src/astronomy.cpp src/skygrid.cpp src/orbit.cpp src/fasttrig.cpp src/satellite.cpp src/apparent.cpp lib/Time/Time.cpp tools/host/host.cpp
+ * ./topocheck
+ * ```
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "astronomy.h"
+
+#define arcsec (180.0 * 3600.0 / pi) // arc seconds per rad
+#define cases 1000000L
+
+/**
+ * pseudo random in [0, 1), the same every run
+ */
+static double random01()
+{
+  static uint64_t seed = 88172645463325252ull;
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return (seed >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * Meeus 40.2 and 40.3, with rho sin and cos of the geocentric latitude from
+ * chapter 11
+ * @param [in] lat_r geographic latitude in rads
+ * @param [in] height above sea level in m
+ * @param [in] sin_par sine of the parallax, 1 / distance in earth radii
+ * @param [in] sidereal_r local sidereal time in rads
+ * @param [in,out] ra_r right ascension in rads
+ * @param [in,out] dc_r declination in rads
+ */
+static void meeus(double lat_r, double height, double sin_par, double sidereal_r,
+                  double *ra_r, double *dc_r)
+{
+  double u = atan(0.99664719 * tan(lat_r));
+  double rho_sin = 0.99664719 * sin(u) + height / 6378140.0 * sin(lat_r);
+  double rho_cos = cos(u) + height / 6378140.0 * cos(lat_r);
+  double H = sidereal_r - *ra_r;
+  double d = cos(*dc_r) - rho_cos * sin_par * cos(H);
+  double dra = atan2(-rho_cos * sin_par * sin(H), d);
+
+  *dc_r = atan((sin(*dc_r) - rho_sin * sin_par) * cos(dra) / d);
+  *ra_r += dra;
+}
+
+/**
+ * @returns difference of two places in rads, of right ascension on the sky
+ */
+static double apart(double ra_h, double dc_d, double ra_r, double dc_r)
+{
+  double dra = remainder(ra_h / 12.0 * pi - ra_r, 2.0 * pi) * cos(dc_r);
+  double ddc = dc_d / 180.0 * pi - dc_r;
+  return fmax(fabs(dra), fabs(ddc));
+}
+
+/**
+ * largest difference with the rigorous formulas
+ * @param [in] index 3 for the moon or the satellite
+ * @param [in] near smallest distance in earth radii
+ * @param [in] far largest distance in earth radii
+ * @param [in] height of the observer in the formulas, in m
+ * @returns arc seconds
+ */
+static double sweep(int index, double near, double far, double height)
+{
+  double worst = 0.0;
+
+  for (long n = 0; n < cases; n++)
+  {
+    double lat_d = random01() * 180.0 - 90.0;
+    double sidereal_r = random01() * 2.0 * pi;
+    double ra_r = random01() * 2.0 * pi;
+    double dc_r = asin(random01() * 2.0 - 1.0);
+    double ro = near + random01() * (far - near);
+    double lat_r = lat_d / 180.0 * pi;
+
+    // the satellite above the horizon only, seen from the center
+    double up = sin(lat_r) * sin(dc_r) + cos(lat_r) * cos(dc_r) * cos(sidereal_r - ra_r);
+    if (index != 3 && up * ro < 1.0)
+      continue;
+
+    double ra_h = ra_r * 12.0 / pi;
+    double dc_d = dc_r * 180.0 / pi;
+    topocentric(index, ro, lat_d, sidereal_r, &ra_h, &dc_d);
+    meeus(lat_r, height, 1.0 / ro, sidereal_r, &ra_r, &dc_r);
+    worst = fmax(worst, apart(ra_h, dc_d, ra_r, dc_r) * arcsec);
+  }
+  return worst;
+}
+
+int main()
+{
+  bool ok = true;
+
+  // example 40.a
+  double lat_d = 33.0 + 21.0 / 60.0 + 22.0 / 3600.0;
+  double ra_d = (22.0 + 38.0 / 60.0 + 7.25 / 3600.0) * 15.0;
+  double dc_d = -(15.0 + 46.0 / 60.0 + 15.9 / 3600.0);
+  double sidereal_r = fmod(288.7958 + ra_d, 360.0) / 180.0 * pi;
+  double ro = 1.0 / sin(23.592 / arcsec);
+  double ra_h = ra_d / 15.0;
+
+  topocentric(3, ro, lat_d, sidereal_r, &ra_h, &dc_d);
+  double mars = apart(ra_h, dc_d, (22.0 + 38.0 / 60.0 + 8.54 / 3600.0) / 12.0 * pi,
+                      -(15.0 + 46.0 / 60.0 + 30.0 / 3600.0) / 180.0 * pi) * arcsec;
+  printf("Mars from Palomar: %.0fh%02.0fm%06.3fs -%.0fd%02.0f'%04.1f\", %.3f\" off\n",
+         floor(ra_h), floor(fmod(ra_h * 60.0, 60.0)), fmod(ra_h * 3600.0, 60.0),
+         floor(-dc_d), floor(fmod(-dc_d * 60.0, 60.0)), fmod(-dc_d * 3600.0, 60.0), mars);
+  ok &= mars <= 0.1;
+
+  double moon = sweep(3, 55.0, 64.0, 0.0);
+  printf("moon:      %.3f\" at most\n", moon);
+  ok &= moon <= 1.0;
+
+  double satellite = sweep(object_satellite, 1.03, 1.2, 0.0);
+  printf("satellite: %.3f\" at most\n", satellite);
+  ok &= satellite <= 60.0;
+
+  printf("satellite: %.3f\" at most from 1706 m\n",
+         sweep(object_satellite, 1.03, 1.2, 1706.0));
+
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
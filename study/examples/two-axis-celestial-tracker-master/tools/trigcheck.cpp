@@ -0,0 +1,106 @@
+/**
+ * @file trigcheck.cpp
+ * @brief Host test of the fixed point trigonometry of FAST_TRIG
+ *
+ * Sweeps fastSin(), fastCos(), fastAtan2() and fastAtan() against the double
+ * precision library and prints the largest error in arc seconds, of the
+ * angle for atan2 and atan, and of the value times 206265 for sin and cos:
+ * - sin and cos at the middle of all 2^24 binary angles of a turn, and at a
+ *   million pseudo random angles up to 20 turns either way, which includes
+ *   the reduction above trig_reduce rads
+ * - atan2 for 2^24 directions around the circle at pseudo random radii
+ * - atan for a million tangents, evenly in the angle
+ * The exit status is not 0 if an error exceeds what fasttrig.h states,
+ * 9.1" for sin and cos and 13" for atan2 and atan.
+ *
+ * The cycles on the AVR are not measured here, that takes avr-gcc and a
+ * simulator.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -Iinclude -o trigcheck tools/trigcheck.cpp src/fasttrig.cpp
+ * ./trigcheck
+ * ```
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "fasttrig.h"
+
+#define arcsec (180.0 * 3600.0 / M_PI) // arc seconds per rad
+
+/**
+ * pseudo random in [0, 1), the same every run
+ */
+static double random01()
+{
+  static uint64_t seed = 88172645463325252ull;
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return (seed >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * difference of two angles, folded into -pi to pi
+ */
+static double angle(double a, double b)
+{
+  return remainder(a - b, 2.0 * M_PI);
+}
+
+/**
+ * @param [in] name of the function
+ * @param [in] error largest error in arc seconds
+ * @param [in] limit in arc seconds
+ * @returns true if within the limit
+ */
+static bool report(const char *name, double error, double limit)
+{
+  printf("%-6s %5.2f\" (limit %.1f\")\n", name, error, limit);
+  return error <= limit;
+}
+
+int main()
+{
+  double sin_error = 0.0;
+  double cos_error = 0.0;
+  double atan2_error = 0.0;
+  double atan_error = 0.0;
+  bool ok = true;
+
+  for (long a = 0; a < (long)trig_units; a++)
+  {
+    double x = (a + 0.5) * (2.0 * M_PI / trig_units);
+    sin_error = fmax(sin_error, fabs(fastSin(x) - sin(x)));
+    cos_error = fmax(cos_error, fabs(fastCos(x) - cos(x)));
+  }
+  for (long n = 0; n < 1000000; n++)
+  {
+    double x = (random01() - 0.5) * 40.0 * 2.0 * M_PI;
+    sin_error = fmax(sin_error, fabs(fastSin(x) - sin(x)));
+    cos_error = fmax(cos_error, fabs(fastCos(x) - cos(x)));
+  }
+
+  for (long a = 0; a < (long)trig_units; a++)
+  {
+    double phi = (a + 0.5) * (2.0 * M_PI / trig_units) - M_PI;
+    double r = pow(10.0, random01() * 12.0 - 6.0);
+    atan2_error = fmax(atan2_error, fabs(angle(fastAtan2(r * sin(phi), r * cos(phi)),
+                                               atan2(sin(phi), cos(phi)))));
+  }
+  for (long n = 0; n < 1000000; n++)
+  {
+    double z = tan((n + 0.5) / 1000000.0 * M_PI - M_PI / 2.0);
+    atan_error = fmax(atan_error, fabs(fastAtan(z) - atan(z)));
+  }
+
+  ok &= report("sin", sin_error * arcsec, 9.1);
+  ok &= report("cos", cos_error * arcsec, 9.1);
+  ok &= report("atan2", atan2_error * arcsec, 13.0);
+  ok &= report("atan", atan_error * arcsec, 13.0);
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file wakesim.cpp
+ * @brief Host simulation of the wake ups of a night of tracking
+ *
+ * Runs update_pointer() of the firmware, as loop() does, through a 12 hour
+ * night from Utrecht (2021-10-17 18:00 UTC), for every object. The time
+ * asleep is rounded down to whole watchdog slices, as sleep() does. Every
+ * second the pointer position is compared with the ticks of the exact
+ * position, while the object is above the horizon, in whichever turn of the
+ * azimuth is closer.
+ *
+ * Printed are the wake ups and the largest pointer error, against those of
+ * the fixed cadence of sleep_default the trajectory replaced. The exit
+ * status is not 0 if an object wakes the processor more often, or the
+ * pointer is further off, than at the fixed cadence.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -Itools/host -Iinclude -Ilib/Time -Ilib/DS3232RTC/src -o wakesim tools/wakesim.cpp src/*.cpp lib/Time/Time.cpp lib/DS3232RTC/src/DS3232RTC.cpp tools/host/host.cpp
+ * ./wakesim
+ * ```
+ */
+
+#include <stdio.h>
+
+#include "main.h"
+#include "host.h"
+
+#define night_start 1634493600L // 2021-10-17 18:00 UTC
+#define night 43200L
+
+extern double loc_lat, loc_lng;
+
+/**
+ * pointer error against the exact position
+ * @param [in] t time in UTC
+ * @param [in] az pointer azimuth in ticks
+ * @param [in] al pointer altitude in ticks
+ * @returns ticks off, azimuth in the closer turn plus altitude, -1 if the
+ * object is below the horizon
+ */
+static int ticks_off(time_t t, int az, int al)
+{
+  int az_ticks;
+  int al_ticks;
+
+  if (get_ticks(t, getSiderealAngle(t, loc_lng), az, &az_ticks, &al_ticks,
+                NULL, NULL, false) < riseset_horizon)
+    return -1;
+  int daz = (az_ticks - az) % steps_per_revolution;
+  if (daz > steps_per_revolution / 2)
+    daz -= steps_per_revolution;
+  else if (daz < -steps_per_revolution / 2)
+    daz += steps_per_revolution;
+  return abs(daz) + abs(al_ticks - al);
+}
+
+/**
+ * simulate the night for one object
+ * @param [in] index of the object
+ * @param [out] error largest pointer error in ticks
+ * @param [out] error_fixed largest pointer error at the fixed cadence
+ * @returns number of wake ups
+ */
+static long simulate(int index, int *error, int *error_fixed)
+{
+  long wakes = 0;
+  time_t t = night_start;
+
+  store_set(store_object, index);
+  trajectory_clear();
+  clearHorizontalCache();
+  *error = 0;
+  while (t < night_start + night)
+  {
+    setTime(t);
+    unsigned long seconds = update_pointer() / sleep_granularity * sleep_granularity;
+    if (seconds == 0)
+      seconds = 1; // awake for a while
+    wakes++;
+
+    int az = journal_read(0);
+    int al = journal_read(1);
+    for (time_t u = t; u < t + (time_t)seconds && u < night_start + night; u++)
+    {
+      int e = ticks_off(u, az, al);
+      if (e > *error)
+        *error = e;
+    }
+    t += seconds;
+  }
+
+  // the pointer set to the exact position every sleep_default seconds
+  *error_fixed = 0;
+  for (t = night_start; t < night_start + night; t += sleep_default)
+  {
+    int az;
+    int al;
+    get_ticks(t, getSiderealAngle(t, loc_lng), journal_read(0), &az, &al, NULL, NULL, false);
+    for (time_t u = t; u < t + sleep_default; u++)
+    {
+      int e = ticks_off(u, az, al);
+      if (e > *error_fixed)
+        *error_fixed = e;
+    }
+  }
+  return wakes;
+}
+
+int main()
+{
+  bool ok = true;
+  long fixed = night / sleep_default;
+
+  host_rtc_set(night_start);
+  setTime(night_start);
+  power_on();
+  getLocation(0, &loc_lat, &loc_lng);
+  for (int index = 0; index <= max_object; index++)
+  {
+    int error;
+    int error_fixed;
+    long wakes = simulate(index, &error, &error_fixed);
+    printf("object %2d: %4ld wake ups, pointer off by %d ticks at most (fixed cadence %ld, %d)\n",
+           index, wakes, error, fixed, error_fixed);
+    if (error > error_fixed || wakes > fixed)
+      ok = false;
+  }
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
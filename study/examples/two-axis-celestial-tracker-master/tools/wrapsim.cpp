@@ -0,0 +1,96 @@
+/**
+ * @file wrapsim.cpp
+ * @brief Host simulation of the cable wrap budget over a night
+ *
+ * Runs update_pointer() of the firmware, as loop() does, through a 13 hour
+ * night from location 0 (2021-10-17 18:00 UTC), for the moon and the six
+ * stars. The time asleep is rounded down to whole watchdog slices, as
+ * sleep() does. The pointer is first brought to the object, which is not
+ * counted. Totalled are the azimuth and altitude steps from wake to wake,
+ * and the unwinds, a move of more than half a turn of azimuth.
+ *
+ * Build once per budget. wrap_budget is 180 degrees, or 360 with WRAP_360,
+ * see stepper.h; other budgets can be set with -Dwrap_budget as below. The
+ * exit status is not 0 if the pointer unwinds more often than once per
+ * object.
+ *
+ * Build and run from the root of the project
+ * ```
+ * g++ -O2 -DARDUINO=10800 -Dwrap_budget=270 -Itools/host -Iinclude -Ilib/Time -Ilib/DS3232RTC/src -o wrapsim tools/wrapsim.cpp src/*.cpp lib/Time/Time.cpp lib/DS3232RTC/src/DS3232RTC.cpp tools/host/host.cpp
+ * ./wrapsim
+ * ```
+ */
+
+#include <stdio.h>
+
+#include "main.h"
+#include "host.h"
+
+#define night_start 1634493600L // 2021-10-17 18:00 UTC
+#define night (13 * 3600L)
+
+extern double loc_lat, loc_lng;
+
+/**
+ * simulate the night for one object
+ * @param [in] index of the object
+ * @param [out] unwinds number of unwinds
+ * @returns number of steps
+ */
+static long simulate(int index, long *unwinds)
+{
+  long steps = 0;
+  time_t t = night_start;
+
+  store_set(store_object, index);
+  trajectory_clear();
+  clearHorizontalCache();
+  setTime(t);
+  update_pointer();
+  int az = journal_read(0);
+  int al = journal_read(1);
+
+  *unwinds = 0;
+  while (t < night_start + night)
+  {
+    setTime(t);
+    unsigned long seconds = update_pointer() / sleep_granularity * sleep_granularity;
+    if (seconds == 0)
+      seconds = sleep_granularity;
+
+    int next_az = journal_read(0);
+    int next_al = journal_read(1);
+    if (abs(next_az - az) > steps_per_revolution / 2)
+      (*unwinds)++;
+    steps += abs(next_az - az) + abs(next_al - al);
+    az = next_az;
+    al = next_al;
+    t += seconds;
+  }
+  return steps;
+}
+
+int main()
+{
+  const int objects[] = {3, 9, 10, 11, 12, 13, 14};
+  long total = 0;
+  long total_unwinds = 0;
+  bool ok = true;
+
+  host_rtc_set(night_start);
+  setTime(night_start);
+  power_on();
+  getLocation(0, &loc_lat, &loc_lng);
+  printf("budget %d degrees\n", wrap_budget);
+  for (unsigned n = 0; n < sizeof(objects) / sizeof(objects[0]); n++)
+  {
+    long unwinds;
+    long steps = simulate(objects[n], &unwinds);
+    printf("object %2d: %6ld steps, %ld unwinds\n", objects[n], steps, unwinds);
+    total += steps;
+    total_unwinds += unwinds;
+    ok &= unwinds <= 1;
+  }
+  printf("total: %ld steps, %ld unwinds\n%s\n", total, total_unwinds, ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
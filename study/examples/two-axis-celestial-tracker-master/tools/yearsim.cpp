@@ -0,0 +1,168 @@
+/**
+ * @file yearsim.cpp
+ * @brief Host simulation of a year of targets with the trajectory compiler
+ *
+ * Runs update_pointer() of the firmware, as loop() does, every fifth night
+ * of 2022, 13 hours from 17:00 UTC, from Utrecht, for the moon and the six
+ * stars. The time asleep is rounded down to whole watchdog slices, as
+ * sleep() does. Every 30 seconds, while the object is more than a degree
+ * above the horizon, the pointer is compared with the exact position of
+ * getHorizontal(): the angle on the sky in degrees.
+ *
+ * trajectory.cpp is compiled into this file, with get_ticks() renamed to a
+ * wrapper that counts the evaluations of the path by the compiler. Printed
+ * per object are the wake ups, against those of the fixed cadence of
+ * sleep_default the trajectory replaced, the evaluations and the mean and
+ * 95th percentile of the pointer error. The exit status is not 0 if an
+ * object wakes the processor more often than at the fixed cadence.
+ *
+ * Build and run from the root of the project, without src/trajectory.cpp
+ * ```
+ * g++ -O2 -DARDUINO=10800 -Itools/host -Iinclude -Ilib/Time -Ilib/DS3232RTC/src -o yearsim tools/yearsim.cpp src/aging.cpp src/apparent.cpp src/astronomy.cpp src/calibrate.cpp src/ds3231.cpp src/fasttrig.cpp src/location.cpp src/main.cpp src/orbit.cpp src/power.cpp src/riseset.cpp src/satellite.cpp src/skygrid.cpp src/stepper.cpp src/store.cpp lib/Time/Time.cpp lib/DS3232RTC/src/DS3232RTC.cpp tools/host/host.cpp
+ * ./yearsim
+ * ```
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "main.h"
+#include "trajectory.h"
+#include "host.h"
+
+#define year_start 1640995200L // 2022-01-01 00:00 UTC
+#define night_offset (17 * 3600L)
+#define night (13 * 3600L)
+#define night_step 5           // days
+#define sample 30              // seconds between comparisons
+#define max_samples ((366 / night_step + 1) * (night / sample + 1))
+
+static long evaluations;
+
+static double counted_ticks(time_t t, double sidereal_r, int az_from, int *az_ticks,
+                            int *al_ticks, double *az_steps, double *al_steps, bool cached)
+{
+  evaluations++;
+  return get_ticks(t, sidereal_r, az_from, az_ticks, al_ticks, az_steps, al_steps, cached);
+}
+
+#define get_ticks counted_ticks
+#include "../src/trajectory.cpp"
+#undef get_ticks
+
+extern double loc_lat, loc_lng;
+
+static double errors[max_samples];
+static long samples;
+
+/**
+ * qsort order
+ */
+static int by_value(const void *a, const void *b)
+{
+  double d = *(const double *)a - *(const double *)b;
+  return d < 0 ? -1 : d > 0 ? 1 : 0;
+}
+
+/**
+ * keep the pointer error at t, if the object is above a degree
+ * @param [in] index of the object
+ * @param [in] t time in UTC
+ * @param [in] az pointer azimuth in ticks
+ * @param [in] al pointer altitude in ticks
+ */
+static void compare(int index, time_t t, int az, int al)
+{
+  double object_az_d;
+  double object_al_d;
+
+  getHorizontal(index, t, loc_lat, getSiderealAngle(t, loc_lng),
+                &object_az_d, &object_al_d, false);
+  if (object_al_d < 1.0)
+    return;
+  double daz = remainder(object_az_d + az * 360.0 / steps_per_revolution, 360.0);
+  double dal = object_al_d - al * 360.0 / steps_per_revolution;
+  daz *= cos(object_al_d / 180.0 * pi);
+  errors[samples++] = sqrt(daz * daz + dal * dal);
+}
+
+/**
+ * simulate the year for one object
+ * @param [in] index of the object
+ * @param [out] nights simulated
+ * @returns number of wake ups
+ */
+static long simulate(int index, long *nights)
+{
+  long wakes = 0;
+
+  store_set(store_object, index);
+  *nights = 0;
+  for (int day = 0; day < 365; day += night_step)
+  {
+    time_t start = year_start + day * 86400L + night_offset;
+    time_t t = start;
+
+    trajectory_clear();
+    clearHorizontalCache();
+    setTime(t);
+    update_pointer(); // to the object, not counted
+    (*nights)++;
+    while (t < start + night)
+    {
+      setTime(t);
+      unsigned long seconds = update_pointer() / sleep_granularity * sleep_granularity;
+      if (seconds == 0)
+        seconds = sleep_granularity;
+      wakes++;
+
+      int az = journal_read(0);
+      int al = journal_read(1);
+      time_t u = t + (sample - (t - start) % sample) % sample; // on the grid from start
+      for (; u < t + (time_t)seconds && u < start + night; u += sample)
+        compare(index, u, az, al);
+      t += seconds;
+    }
+  }
+  return wakes;
+}
+
+int main()
+{
+  const int objects[] = {3, 9, 10, 11, 12, 13, 14};
+  long total = 0;
+  long total_fixed = 0;
+  long total_evaluations = 0;
+  bool ok = true;
+
+  host_rtc_set(year_start);
+  setTime(year_start);
+  power_on();
+  getLocation(0, &loc_lat, &loc_lng);
+  for (unsigned n = 0; n < sizeof(objects) / sizeof(objects[0]); n++)
+  {
+    long nights;
+    evaluations = 0;
+    samples = 0;
+    long wakes = simulate(objects[n], &nights);
+    long fixed = nights * night / sleep_default;
+
+    qsort(errors, samples, sizeof(double), by_value);
+    double mean = 0.0;
+    for (long k = 0; k < samples; k++)
+      mean += errors[k];
+    mean /= samples;
+
+    printf("object %2d: %6ld wake ups (fixed cadence %6ld), %7ld evaluations, "
+           "error mean %.3f p95 %.3f deg\n",
+           objects[n], wakes, fixed, evaluations, mean, errors[samples * 95 / 100]);
+    total += wakes;
+    total_fixed += fixed;
+    total_evaluations += evaluations;
+    ok &= wakes <= fixed;
+  }
+  printf("total: %ld wake ups (fixed cadence %ld, %+.0f %%), %ld evaluations\n",
+         total, total_fixed, (total - total_fixed) * 100.0 / total_fixed, total_evaluations);
+  printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}